@@ -0,0 +1,162 @@
+#include <Date/Actual_360.h>
+#include <Instrument/Deposit/Deposit.h>
+#include <Instrument/FRA/FRA.h>
+#include <Instrument/Swap/Swap.h>
+#include <DiscountFactorBootstrap/DiscountFactorBootstrap.h>
+#include <DiscountFactorBootstrap/GlobalDiscountFactorSolver.h>
+#include <LatencyRecorder/LatencyRecorder.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// Benchmark of the discount factor curve bootstrap on synthetic instrument strips.
+// Usage: bench_bootstrap [repetitions] [number of pillars...]   (default: 20 repetitions of 50, 200 and 1000 pillars)
+// The results are printed as JSON (median and p99 of each step in seconds, and allocations of one build), so the
+// solver strategies can be compared between versions
+
+using namespace std;
+
+// Count the allocations of the whole program (the benchmark reads the difference around each build)
+std::atomic<long> numAllocations(0);
+
+void* operator new(std::size_t size)
+{
+    numAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* memory = std::malloc(size > 0 ? size : 1);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+// Monthly pillars: deposits up to 3 months, 3 month FRAs up to 1 year and swaps after that
+std::vector<Instrument *> buildStrip(int numPillars){
+
+    std::vector<Instrument *> instrumentVector;
+    for (int month = 1; month <= numPillars; ++month) {
+        double rate = 0.03 + 0.02 * (1 - exp(-month / 120.0));
+        if (month <= 3) {
+            instrumentVector.push_back(new Deposit<Actual_360>(rate, month));
+        }
+        else if (month <= 12) {
+            instrumentVector.push_back(new FRA<Actual_360>(rate, month - 3, month));
+        }
+        else {
+            instrumentVector.push_back(new Swap<Actual_360>(rate, month));
+        }
+    }
+    return instrumentVector;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void printLatency(const char* name, LatencyRecorder& latency){
+    printf("\"%s_p50\": %.9f, \"%s_p99\": %.9f, ", name, latency.getP50(), name, latency.getP99());
+}
+
+void benchmark(int numPillars, int repetitions, bool first){
+
+    std::vector<Instrument *> instrumentVector = buildStrip(numPillars);
+    std::mt19937 generator(numPillars);
+    LatencyRecorder sortLatency, discountFactorLatency, splineLatency, totalLatency, globalLatency;
+    long bootstrapAllocations = 0;
+    long globalAllocations = 0;
+    int splineSolves = 0;
+    int globalIterations = 0;
+
+    for (int r = 0; r < repetitions; ++r) {
+        // Sort a shuffled strip (the quotes do not arrive in order)
+        std::vector<Instrument *> shuffled = instrumentVector;
+        std::shuffle(shuffled.begin(), shuffled.end(), generator);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::sort(shuffled.begin(), shuffled.end(), compareEndPeriods);
+        sortLatency.record(secondsSince(start));
+
+        // Discount factors one by one (the spline is only solved when a FRA interpolates)
+        start = std::chrono::steady_clock::now();
+        DiscountFactorCurve curve;
+        for (int i = 0; i < shuffled.size(); ++i) {
+            DiscountFactor discountFactor = shuffled[i]->getDiscountFactor(curve);
+            curve.addPoint(discountFactor.getYearsFromPresentValue(), discountFactor.getDiscountFactor());
+        }
+        discountFactorLatency.record(secondsSince(start));
+        splineSolves = curve.getNumberOfSplineSolves();
+
+        // Spline of the whole curve
+        start = std::chrono::steady_clock::now();
+        curve.interpolate();
+        splineLatency.record(secondsSince(start));
+        splineSolves = splineSolves + 1;
+
+        // Whole sequential bootstrap
+        DiscountFactorBootstrap discountFactorBootstrap;
+        long allocations = numAllocations.load();
+        start = std::chrono::steady_clock::now();
+        discountFactorBootstrap.bootstrap(shuffled);
+        totalLatency.record(secondsSince(start));
+        bootstrapAllocations = numAllocations.load() - allocations;
+
+        // Global solver
+        GlobalDiscountFactorSolver solver;
+        allocations = numAllocations.load();
+        start = std::chrono::steady_clock::now();
+        solver.solve(shuffled);
+        globalLatency.record(secondsSince(start));
+        globalAllocations = numAllocations.load() - allocations;
+        globalIterations = solver.getNumberOfIterations();
+    }
+
+    printf("%s\n    {\"pillars\": %d, \"repetitions\": %d, ", first ? "" : ",", numPillars, repetitions);
+    printLatency("sort_seconds", sortLatency);
+    printLatency("discount_factor_seconds", discountFactorLatency);
+    printLatency("spline_seconds", splineLatency);
+    printf("\"spline_solves\": %d,\n     \"sequential\": {", splineSolves);
+    printLatency("total_seconds", totalLatency);
+    printf("\"allocations\": %ld},\n     \"global\": {", bootstrapAllocations);
+    printLatency("total_seconds", globalLatency);
+    printf("\"iterations\": %d, \"allocations\": %ld}}", globalIterations, globalAllocations);
+
+    for (int i = 0; i < instrumentVector.size(); ++i) {
+        delete instrumentVector[i];
+    }
+}
+
+int main(int argc, char* argv[]) {
+
+    int repetitions = (argc > 1) ? atoi(argv[1]) : 20;
+    std::vector<int> sizes;
+    for (int i = 2; i < argc; ++i) {
+        sizes.push_back(atoi(argv[i]));
+    }
+    if (sizes.empty()) {
+        sizes.push_back(50);
+        sizes.push_back(200);
+        sizes.push_back(1000);
+    }
+
+    printf("{\"benchmark\": \"bootstrap\", \"results\": [");
+    for (int i = 0; i < sizes.size(); ++i) {
+        benchmark(sizes[i], repetitions, i == 0);
+    }
+    printf("\n]}\n");
+    return 0;
+}
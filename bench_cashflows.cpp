@@ -0,0 +1,131 @@
+#include <Date/Actual_360.h>
+#include <ZeroCouponYieldCurve/ZeroCouponYieldCurve.h>
+#include <Instrument/Swap/Swap.h>
+#include <CashflowStore/CashflowStore.h>
+#include <LatencyRecorder/LatencyRecorder.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Benchmark of the present value of a portfolio of swaps: one Swap object per trade (a vector of Payment per leg and
+// a discount factor per payment) against the CashflowStore (one discount factor per distinct payment date, a gather
+// and a segmented sum by trade), and against the compressed store (the fix amounts summed by trade and date once and
+// their rows dropped, so a new set of discount factors costs one product per attribution and one per float cashflow).
+// Usage: bench_cashflows [repetitions] [number of cashflows]   (default: 20 repetitions of 1000000 cashflows)
+// The results are printed as JSON (median and p99 of each path in seconds)
+
+using namespace std;
+
+typedef ZeroCouponYieldCurve<Actual_360> ZeroCurve;
+
+double secondsSince(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void printLatency(const char* name, LatencyRecorder& latency){
+    printf("\"%s_p50\": %.9f, \"%s_p99\": %.9f, ", name, latency.getP50(), name, latency.getP99());
+}
+
+int main(int argc, char* argv[]) {
+
+    int repetitions = (argc > 1) ? atoi(argv[1]) : 20;
+    int numCashflows = (argc > 2) ? atoi(argv[2]) : 1000000;
+
+    // Semiannual zero coupon curve up to 10 years
+    Actual_360 actual360 = Actual_360();
+    std::tm presentDate = actual360.make_tm(2016, 04, 01);
+    std::shared_ptr<ZeroCurve> zeroCouponCurve = std::make_shared<ZeroCurve>(actual360, presentDate);
+    for (int k = 1; k <= 20; ++k) {
+        zeroCouponCurve->addZeroCouponRate(actual360.make_tm(2016 + k / 2, (k % 2 == 1) ? 10 : 4, 1), 0.03 + 0.001 * k);
+    }
+    zeroCouponCurve->computeZeroCurve();
+
+    // 10 year semiannual swaps (40 cashflows with both legs) starting on one of 20 business days
+    std::vector<std::vector<std::tm>> calendars(20);
+    for (int start = 0; start < calendars.size(); ++start) {
+        for (int k = 1; k <= 20; ++k) {
+            calendars[start].push_back(actual360.make_tm(2016 + k / 2, (k % 2 == 1) ? 10 : 4, 1 + start));
+        }
+    }
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    int numSwaps = std::max(numCashflows / 40, 1);
+    std::vector<Swap<ZeroCurve> *> swaps;
+    CashflowStore store;
+    for (int i = 0; i < numSwaps; ++i) {
+        swaps.push_back(new Swap<ZeroCurve>(1e6 * (1 + 99 * uniform(generator)), zeroCouponCurve,
+                                            calendars[i % calendars.size()], 0.02 + 0.03 * uniform(generator)));
+        int trade = store.addTrade();
+        store.addLeg(trade, swaps.back()->getFixPayments(), 1);
+        store.addLeg(trade, swaps.back()->getVariablePayments(), -1, 0, true);
+    }
+    store.setZeroCouponCurve(*zeroCouponCurve);
+
+    CashflowStore compressedStore = store;
+    std::chrono::steady_clock::time_point compressStart = std::chrono::steady_clock::now();
+    compressedStore.compress();
+    double compressSeconds = secondsSince(compressStart);
+
+    LatencyRecorder objectLatency, storeLatency, discountFactorLatency, compressedLatency, compressedTotalLatency;
+    std::vector<double> objectValues(numSwaps);
+    std::vector<double> storeValues, compressedValues;
+    double compressedTotal = 0;
+    for (int r = 0; r < repetitions; ++r) {
+        // One object per trade
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < numSwaps; ++i) {
+            objectValues[i] = swaps[i]->computePresentValue();
+        }
+        objectLatency.record(secondsSince(start));
+
+        // Cashflow store: discount factors of the distinct dates, and then the gather and the sum by trade
+        start = std::chrono::steady_clock::now();
+        store.setZeroCouponCurve(*zeroCouponCurve);
+        discountFactorLatency.record(secondsSince(start));
+        store.computePresentValues(storeValues);
+        storeLatency.record(secondsSince(start));
+
+        // Compressed store: the same discount factors (the forwards do not change), by trade and for the portfolio
+        start = std::chrono::steady_clock::now();
+        compressedStore.setZeroCouponCurve(*zeroCouponCurve);
+        compressedStore.computeCompressedPresentValues(compressedValues);
+        compressedLatency.record(secondsSince(start));
+        start = std::chrono::steady_clock::now();
+        compressedTotal = compressedStore.computeCompressedPresentValue();
+        compressedTotalLatency.record(secondsSince(start));
+    }
+
+    // Both paths give the same present values
+    double maxDifference = 0;
+    double objectTotal = 0;
+    for (int i = 0; i < numSwaps; ++i) {
+        maxDifference = std::max(maxDifference, std::abs(objectValues[i] - storeValues[i]) / (1 + std::abs(objectValues[i])));
+        maxDifference = std::max(maxDifference, std::abs(objectValues[i] - compressedValues[i]) / (1 + std::abs(objectValues[i])));
+        objectTotal = objectTotal + objectValues[i];
+    }
+    maxDifference = std::max(maxDifference, std::abs(objectTotal - compressedTotal) / (1 + std::abs(objectTotal)));
+
+    printf("{\"benchmark\": \"cashflows\", \"cashflows\": %d, \"trades\": %d, \"payment_dates\": %d, \"repetitions\": %d,\n",
+           store.getNumberOfCashflows(), store.getNumberOfTrades(), store.getNumberOfTimes(), repetitions);
+    printf(" \"objects\": {");
+    printLatency("total_seconds", objectLatency);
+    printf("\"discount_factors\": %d},\n \"cashflow_store\": {", store.getNumberOfCashflows());
+    printLatency("discount_factor_seconds", discountFactorLatency);
+    printLatency("total_seconds", storeLatency);
+    printf("\"discount_factors\": %d},\n \"compressed_store\": {\"compress_seconds\": %.9f, ", store.getNumberOfTimes(), compressSeconds);
+    printLatency("total_seconds", compressedLatency);
+    printLatency("portfolio_total_seconds", compressedTotalLatency);
+    printf("\"cashflows_kept\": %d, \"attributions\": %d},\n \"speedup_p50\": %.2f, \"compressed_speedup_p50\": %.2f, \"max_relative_difference\": %.3g}\n",
+           compressedStore.getNumberOfCashflows(), compressedStore.getNumberOfAttributions(), objectLatency.getP50() / storeLatency.getP50(),
+           objectLatency.getP50() / compressedLatency.getP50(), maxDifference);
+
+    for (int i = 0; i < swaps.size(); ++i) {
+        delete swaps[i];
+    }
+    return 0;
+}
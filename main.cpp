@@ -2,8 +2,27 @@
 #include <Date/Actual_360.h>
 #include <ZeroCouponYieldCurve/ZeroCouponYieldCurve.h>
 #include <Instrument/Swap/Swap.h>
+#include <Instrument/Bond/Bond.h>
+#include <CurveRegistry/CurveRegistry.h>
+#include <CurvePublisher/CurvePublisher.h>
+#include <CurveSnapshotStore/CurveSnapshotStore.h>
+#include <CurveImage/CurveImage.h>
+#include <MarketQuotes/QuoteReader.h>
 #include <Instrument/Deposit/Deposit.h>
+#include <Instrument/FRA/FRA.h>
+#include <Instrument/ScheduledSwap/ScheduledSwap.h>
+#include <Instrument/OIS/OIS.h>
+#include <DiscountFactorBootstrap/DiscountFactorBootstrap.h>
+#include <DiscountFactorBootstrap/GlobalDiscountFactorSolver.h>
+#include <CurveBuildScheduler/CurveBuildScheduler.h>
+#include <CashflowStore/CashflowStore.h>
+#include <InstrumentArena/InstrumentArena.h>
+#include <BondAnalytics/BondAnalytics.h>
+#include <PortfolioValuation/PortfolioValuation.h>
+#include <ValuationCache/ValuationCache.h>
 #include <cmath>
+#include <memory>
+#include <thread>
 #include <Instrument/Options/Option.h>
 #include <Instrument/Options/Call/Call.h>
 #include <Instrument/Options/Put/Put.h>
@@ -143,6 +162,818 @@ void testValuations(){
     }
 }
 
+void testMultiCurveValuations(){
+
+    // Discount with the OIS curve and project the float leg with the 6 month curve
+    Actual_360 actual360 = Actual_360();
+    std::tm presentDate = actual360.make_tm(2016, 04, 01);
+    ZeroCouponYieldCurve<Actual_360> oisCurve = ZeroCouponYieldCurve<Actual_360>(actual360, presentDate);
+    ZeroCouponYieldCurve<Actual_360> sixMonthCurve = ZeroCouponYieldCurve<Actual_360>(actual360, presentDate);
+    std::vector<std::tm> paymentDates;
+
+    paymentDates.push_back(actual360.make_tm(2016, 10, 03));
+    paymentDates.push_back(actual360.make_tm(2017, 04, 03));
+    paymentDates.push_back(actual360.make_tm(2017, 10, 02));
+    paymentDates.push_back(actual360.make_tm(2018, 04, 02));
+
+    double oisRate[] = {0.0450, 0.0470, 0.0480, 0.0490};
+    double sixMonthRate[] = {0.0474, 0.0500, 0.0510, 0.0520};
+
+    for( int i = 0; i < paymentDates.size(); ++i)
+    {
+        oisCurve.addZeroCouponRate(paymentDates[i], oisRate[i]);
+        sixMonthCurve.addZeroCouponRate(paymentDates[i], sixMonthRate[i]);
+    }
+    oisCurve.computeZeroCurve();
+    sixMonthCurve.computeZeroCurve();
+
+    CurveRegistry<ZeroCouponYieldCurve<Actual_360>> registry;
+    registry.addDiscountCurve(CurveKey("EUR", "ESTR", "ON"), oisCurve);
+    registry.addForwardCurve(CurveKey("EUR", "EURIBOR", "6M"), sixMonthCurve);
+
+    Swap<ZeroCouponYieldCurve<Actual_360>> swap = Swap<ZeroCouponYieldCurve<Actual_360>>(100000000, registry,
+            CurveKey("EUR", "ESTR", "ON"), CurveKey("EUR", "EURIBOR", "6M"), paymentDates, 0.05);
+
+    // A swap on a curve that is not registered is rejected when it is built
+    bool unknownKeyRejected = false;
+    try {
+        Swap<ZeroCouponYieldCurve<Actual_360>>(100000000, registry, CurveKey("USD", "SOFR", "ON"),
+                                               CurveKey("EUR", "EURIBOR", "6M"), paymentDates, 0.05);
+    }
+    catch (const std::invalid_argument&) {
+        unknownKeyRejected = true;
+    }
+
+    // Test the curves are resolved by id and the discount factors come from the OIS curve
+    if (swap.getDiscountCurveId() == 0 && swap.getForwardCurveId() == 0 &&
+        registry.getDiscountCurveId(CurveKey("EUR", "EURIBOR", "6M")) == -1 && unknownKeyRejected){
+        std::cout << "Multi-curve swap curve resolution test okay " << endl;
+    }
+
+    double firstPaymentInYears = oisCurve.getTimeInYearsFromPresentDate(paymentDates[0]);
+    if (abs(swap.getDiscountFactor(0) - exp(-0.0450 * firstPaymentInYears)) <= 1e-10){
+        std::cout << "Multi-curve swap OIS discount factor test okay " << endl;
+    }
+
+    if (abs(swap.getVariableForward(0) - sixMonthCurve.getForward(presentDate, paymentDates[0])) <= 1e-10){
+        std::cout << "Multi-curve swap projected forward test okay " << endl;
+    }
+}
+
+void testLazySwapLegs(){
+
+    Actual_360 actual360 = Actual_360();
+    std::tm presentDate = actual360.make_tm(2016, 04, 01);
+    typedef ZeroCouponYieldCurve<Actual_360> ZeroCurve;
+    std::shared_ptr<ZeroCurve> zeroCouponCurve = std::make_shared<ZeroCurve>(actual360, presentDate);
+    ZeroCurve otherCurve = ZeroCurve(actual360, presentDate);
+    std::vector<std::tm> paymentDates;
+
+    paymentDates.push_back(actual360.make_tm(2016, 10, 03));
+    paymentDates.push_back(actual360.make_tm(2017, 04, 03));
+    paymentDates.push_back(actual360.make_tm(2017, 10, 02));
+    paymentDates.push_back(actual360.make_tm(2018, 04, 02));
+
+    double interestRate[] = {0.0474, 0.0500, 0.0510, 0.0520};
+    for( int i = 0; i < paymentDates.size(); ++i)
+    {
+        zeroCouponCurve->addZeroCouponRate(paymentDates[i], interestRate[i]);
+        otherCurve.addZeroCouponRate(paymentDates[i], interestRate[i] + 0.002);
+    }
+    zeroCouponCurve->computeZeroCurve();
+    otherCurve.computeZeroCurve();
+    otherCurve.updateRate(2, 0.0550);
+
+    // Loading the swap does not read the curve: the legs are generated by the first valuation and then reused
+    Swap<ZeroCurve> swap = Swap<ZeroCurve>(100000000, zeroCouponCurve, paymentDates, 0.05);
+    Swap<ZeroCurve> copySwap = Swap<ZeroCurve>(100000000, *zeroCouponCurve, paymentDates, 0.05);
+    int generationsAfterLoad = swap.getNumberOfLegGenerations();
+    double presentValue = swap.computePresentValue();
+    swap.computePresentValue();
+    int generationsAfterValuations = swap.getNumberOfLegGenerations();
+    Bond<ZeroCurve> bond = Bond<ZeroCurve>(1000000, zeroCouponCurve, paymentDates, 0.06);
+    Bond<ZeroCurve> copyBond = Bond<ZeroCurve>(1000000, *zeroCouponCurve, paymentDates, 0.06);
+    double bondPresentValue = bond.computePresentValue();
+
+    // A new version of the curve only refreshes the rates and forwards of the payments (no new day counts), and gives
+    // the values of instruments loaded on the moved curve. The swap with its own copy of the curve does not move
+    zeroCouponCurve->updateRate(2, 0.0530);
+    double movedPresentValue = swap.computePresentValue();
+    Swap<ZeroCurve> movedSwap = Swap<ZeroCurve>(100000000, *zeroCouponCurve, paymentDates, 0.05);
+    Bond<ZeroCurve> movedBond = Bond<ZeroCurve>(1000000, *zeroCouponCurve, paymentDates, 0.06);
+    bool sameBond = abs(bond.computePresentValue() - movedBond.computePresentValue()) <= 1e-8 &&
+                    bond.getNumberOfPaymentGenerations() == 1 && bond.getNumberOfPaymentRefreshes() == 1;
+    bool copyUnchanged = copySwap.computePresentValue() == presentValue && copyBond.computePresentValue() == bondPresentValue;
+
+    // A curve assigned over the shared one has another version, even if it changed as many times
+    *zeroCouponCurve = otherCurve;
+    Swap<ZeroCurve> otherSwap = Swap<ZeroCurve>(100000000, otherCurve, paymentDates, 0.05);
+    Bond<ZeroCurve> otherBond = Bond<ZeroCurve>(1000000, otherCurve, paymentDates, 0.06);
+    bool reassigned = abs(swap.computePresentValue() - otherSwap.computePresentValue()) <= 1e-8 && swap.getNumberOfLegRefreshes() == 2 &&
+                      abs(bond.computePresentValue() - otherBond.computePresentValue()) <= 1e-8 && bond.getNumberOfPaymentRefreshes() == 2;
+
+    if (generationsAfterLoad == 0 && generationsAfterValuations == 1 && swap.getNumberOfLegGenerations() == 1 &&
+        movedPresentValue != presentValue && abs(movedPresentValue - movedSwap.computePresentValue()) <= 1e-8 &&
+        sameBond && copyUnchanged && reassigned){
+        std::cout << "Lazy swap legs test okay " << endl;
+    }
+    else{
+        std::cout << "Lazy swap legs error " << sameBond << copyUnchanged << reassigned << endl;
+    }
+}
+
+void testSwapAnalytics(){
+
+    Actual_360 actual360 = Actual_360();
+    std::tm presentDate = actual360.make_tm(2016, 04, 01);
+    typedef ZeroCouponYieldCurve<Actual_360> ZeroCurve;
+    ZeroCurve zeroCouponCurve = ZeroCurve(actual360, presentDate);
+    std::vector<std::tm> paymentDates;
+    paymentDates.push_back(actual360.make_tm(2016, 10, 03));
+    paymentDates.push_back(actual360.make_tm(2017, 04, 03));
+    paymentDates.push_back(actual360.make_tm(2017, 10, 02));
+    paymentDates.push_back(actual360.make_tm(2018, 04, 02));
+    double interestRate[] = {0.0474, 0.0500, 0.0510, 0.0520};
+    for (int i = 0; i < paymentDates.size(); ++i) {
+        zeroCouponCurve.addZeroCouponRate(paymentDates[i], interestRate[i]);
+    }
+    zeroCouponCurve.computeZeroCurve();
+
+    // Grid of quotes: swaps of 1 to 4 periods
+    std::vector<Swap<ZeroCurve>*> grid;
+    for (int tenor = 1; tenor <= paymentDates.size(); ++tenor) {
+        std::vector<std::tm> calendar(paymentDates.begin(), paymentDates.begin() + tenor);
+        grid.push_back(new Swap<ZeroCurve>(100000000, zeroCouponCurve, calendar, 0.05));
+    }
+    std::vector<SwapAnalytics> analytics;
+    computeSwapAnalytics(grid, analytics);
+
+    // Same present value as the legs valued one by one, zero present value at the par rate, and the PV01 is the
+    // change of the present value with the fix rate 1 basis point higher
+    double error = 0;
+    for (int i = 0; i < grid.size(); ++i) {
+        std::vector<std::tm> calendar(paymentDates.begin(), paymentDates.begin() + i + 1);
+        Swap<ZeroCurve> parSwap = Swap<ZeroCurve>(100000000, zeroCouponCurve, calendar, analytics[i].parRate);
+        Swap<ZeroCurve> bumpedSwap = Swap<ZeroCurve>(100000000, zeroCouponCurve, calendar, 0.0501);
+        error = error + abs(analytics[i].presentValue - grid[i]->computePresentValue()) + abs(parSwap.computePresentValue()) +
+                abs(bumpedSwap.computePresentValue() - analytics[i].presentValue - analytics[i].pv01);
+    }
+    if (error <= 1e-5 && grid[0]->getNumberOfLegGenerations() == 1){
+        std::cout << "Swap analytics in one pass test okay " << endl;
+    }
+    else{
+        std::cout << "Swap analytics error: " << error << endl;
+    }
+    for (int i = 0; i < grid.size(); ++i) {
+        delete grid[i];
+    }
+}
+
+void testPortfolioValuation(){
+
+    // Semiannual zero coupon curve up to 20 years
+    Actual_360 actual360 = Actual_360();
+    std::tm presentDate = actual360.make_tm(2016, 04, 01);
+    typedef ZeroCouponYieldCurve<Actual_360> ZeroCurve;
+    std::shared_ptr<ZeroCurve> zeroCouponCurve = std::make_shared<ZeroCurve>(actual360, presentDate);
+    std::vector<std::tm> paymentDates;
+    for (int k = 1; k <= 40; ++k) {
+        paymentDates.push_back(actual360.make_tm(2016 + k / 2, (k % 2 == 1) ? 10 : 4, 1));
+        zeroCouponCurve->addZeroCouponRate(paymentDates.back(), 0.03 + 0.0005 * k);
+    }
+    zeroCouponCurve->computeZeroCurve();
+
+    // Trades of very different costs: bonds of 1 or 2 payments and swaps of 1 to 40 periods (up to 80 payments)
+    std::vector<Bond<ZeroCurve>*> bonds;
+    std::vector<Swap<ZeroCurve>*> swaps;
+    PortfolioValuation sequential, portfolio(4);
+    for (int i = 0; i < 500; ++i) {
+        int periods = 1 + (i * 7) % paymentDates.size();
+        std::vector<std::tm> calendar(paymentDates.begin(), paymentDates.begin() + periods);
+        if (i % 4 == 0) {
+            calendar.resize(1 + i % 2);
+            bonds.push_back(new Bond<ZeroCurve>(1000000, zeroCouponCurve, calendar, 0.04));
+            sequential.addTrade(bonds.back());
+            portfolio.addTrade(bonds.back());
+        }
+        else {
+            swaps.push_back(new Swap<ZeroCurve>(1000000 * (1 + i % 13), zeroCouponCurve, calendar, 0.02 + 0.0001 * i));
+            sequential.addTrade(swaps.back());
+            portfolio.addTrade(swaps.back());
+        }
+    }
+    sequential.run();
+
+    // The same present values and the same total (bit by bit) with any number of threads
+    bool identical = true;
+    int threads[] = {1, 2, 4};
+    for (int t = 0; t < 3; ++t) {
+        ThreadPool pool(threads[t]);
+        portfolio.run(pool);
+        identical = identical && portfolio.getPresentValues() == sequential.getPresentValues() &&
+                    portfolio.getTotalPresentValue() == sequential.getTotalPresentValue();
+    }
+    double total = 0;
+    for (int i = 0; i < bonds.size(); ++i) {
+        total = total + bonds[i]->computePresentValue();
+    }
+    for (int i = 0; i < swaps.size(); ++i) {
+        total = total + swaps[i]->computePresentValue();
+    }
+    if (identical && abs(portfolio.getTotalPresentValue() - total) <= 1e-6 * abs(total) &&
+        portfolio.getPresentValue(0) == bonds[0]->computePresentValue()){
+        std::cout << "Parallel portfolio valuation test okay " << endl;
+    }
+    else{
+        std::cout << "Parallel portfolio valuation error " << endl;
+    }
+    for (int i = 0; i < bonds.size(); ++i) {
+        delete bonds[i];
+    }
+    for (int i = 0; i < swaps.size(); ++i) {
+        delete swaps[i];
+    }
+}
+
+void testValuationCache(){
+
+    Actual_360 actual360 = Actual_360();
+    std::tm presentDate = actual360.make_tm(2016, 04, 01);
+    typedef ZeroCouponYieldCurve<Actual_360> ZeroCurve;
+    std::shared_ptr<ZeroCurve> zeroCouponCurve = std::make_shared<ZeroCurve>(actual360, presentDate);
+    std::vector<std::tm> paymentDates;
+    paymentDates.push_back(actual360.make_tm(2016, 10, 03));
+    paymentDates.push_back(actual360.make_tm(2017, 04, 03));
+    paymentDates.push_back(actual360.make_tm(2017, 10, 02));
+    paymentDates.push_back(actual360.make_tm(2018, 04, 02));
+    double interestRate[] = {0.0474, 0.0500, 0.0510, 0.0520};
+    for (int i = 0; i < paymentDates.size(); ++i) {
+        zeroCouponCurve->addZeroCouponRate(paymentDates[i], interestRate[i]);
+    }
+    zeroCouponCurve->computeZeroCurve();
+
+    // Book of 10 swaps valued by 3 requests: the second one is served by the cache
+    std::vector<Swap<ZeroCurve>*> swaps;
+    for (int i = 0; i < 10; ++i) {
+        swaps.push_back(new Swap<ZeroCurve>(1000000 * (i + 1), zeroCouponCurve, paymentDates, 0.045 + 0.001 * i));
+    }
+    ValuationCache cache;
+    int numValuations = 0;
+    std::vector<double> presentValues(swaps.size());
+    for (int request = 0; request < 3; ++request) {
+        if (request == 2) {
+            zeroCouponCurve->updateRate(2, 0.0530);  // New version of the curve: every trade is valued again
+        }
+        std::vector<unsigned long> curveVersions(1, zeroCouponCurve->getVersion());
+        for (int i = 0; i < swaps.size(); ++i) {
+            Swap<ZeroCurve>* swap = swaps[i];
+            presentValues[i] = cache.getPresentValue(i, 0, curveVersions, [swap, &numValuations](){
+                numValuations = numValuations + 1;
+                return swap->computePresentValue();
+            });
+        }
+    }
+    bool curveInvalidation = numValuations == 20 && cache.getNumberOfHits() == 10 && cache.getNumberOfInvalidations() == 10 &&
+                             abs(presentValues[3] - swaps[3]->computePresentValue()) <= 1e-9;
+
+    // A new version of the trade, and the risk stored with the present value
+    std::vector<unsigned long> curveVersions(1, zeroCouponCurve->getVersion());
+    std::vector<double> risk;
+    cache.getPresentValue(0, 1, curveVersions, [&swaps](std::vector<double>& tradeRisk){
+        SwapAnalytics analytics = swaps[0]->computeAnalytics();
+        tradeRisk.push_back(analytics.pv01);
+        return analytics.presentValue;
+    }, risk);
+    double cachedPresentValue = 0;
+    std::vector<double> cachedRisk;
+    bool tradeInvalidation = cache.find(0, 1, curveVersions, cachedPresentValue, &cachedRisk) &&
+                             cachedRisk.size() == 1 && cachedRisk[0] == swaps[0]->computeAnalytics().pv01 &&
+                             !cache.find(0, 0, curveVersions, cachedPresentValue) && !cache.find(1, 0, curveVersions, cachedPresentValue, &cachedRisk);
+
+    // Bounded memory: only the most recently used valuations are kept
+    ValuationCache smallCache(4 * 256);
+    for (int i = 0; i < 100; ++i) {
+        smallCache.insert(i, 0, curveVersions, i);
+    }
+    bool bounded = smallCache.getMemoryBytes() <= 4 * 256 && smallCache.getNumberOfEvictions() == 100 - smallCache.getNumberOfEntries() &&
+                   smallCache.find(99, 0, curveVersions, cachedPresentValue) && !smallCache.find(0, 0, curveVersions, cachedPresentValue);
+
+    // A curve built again has a new version, even with the same points
+    std::vector<Instrument*> instruments;
+    instruments.push_back(new Deposit<Actual_360>(0.05, 6));
+    instruments.push_back(new Swap<Actual_360>(0.055, 12));
+    instruments.push_back(new Swap<Actual_360>(0.06, 18));
+    DiscountFactorCurve firstBuild = DiscountFactorBootstrap().bootstrap(instruments);
+    DiscountFactorCurve secondBuild = DiscountFactorBootstrap().bootstrap(instruments);
+    bool bootstrapVersions = firstBuild.getVersion() != secondBuild.getVersion() && DiscountFactorCurve().getVersion() == 0;
+
+    // Two curves built independently with the same number of changes (the same version with a counter per curve):
+    // a valuation stored with one of them is a miss for the other
+    ZeroCurve eurCurve(actual360, presentDate), usdCurve(actual360, presentDate);
+    for (int i = 0; i < paymentDates.size(); ++i) {
+        eurCurve.addZeroCouponRate(paymentDates[i], interestRate[i]);
+        usdCurve.addZeroCouponRate(paymentDates[i], interestRate[i] + 0.01);
+    }
+    eurCurve.computeZeroCurve();
+    usdCurve.computeZeroCurve();
+    Swap<ZeroCurve> eurSwap(1000000, eurCurve, paymentDates, 0.05);
+    Swap<ZeroCurve> usdSwap(1000000, usdCurve, paymentDates, 0.05);
+    ValuationCache curveCache;
+    curveCache.getPresentValue(0, 0, std::vector<unsigned long>(1, eurCurve.getVersion()), [&eurSwap](){
+        return eurSwap.computePresentValue();
+    });
+    double usdPresentValue = curveCache.getPresentValue(0, 0, std::vector<unsigned long>(1, usdCurve.getVersion()), [&usdSwap](){
+        return usdSwap.computePresentValue();
+    });
+    bool independentCurves = eurCurve.getVersion() != usdCurve.getVersion() && curveCache.getNumberOfHits() == 0 &&
+                             curveCache.getNumberOfInvalidations() == 1 && usdPresentValue == usdSwap.computePresentValue();
+
+    if (curveInvalidation && tradeInvalidation && bounded && bootstrapVersions && independentCurves && cache.getHitRate() > 0){
+        std::cout << "Valuation cache test okay " << endl;
+    }
+    else{
+        std::cout << "Valuation cache error: " << curveInvalidation << tradeInvalidation << bounded << bootstrapVersions
+                  << independentCurves << endl;
+    }
+    for (int i = 0; i < swaps.size(); ++i) {
+        delete swaps[i];
+    }
+    for (int i = 0; i < instruments.size(); ++i) {
+        delete instruments[i];
+    }
+}
+
+void testCurvePublication(){
+
+    Actual_360 actual360 = Actual_360();
+    std::tm presentDate = actual360.make_tm(2016, 04, 01);
+    ZeroCouponYieldCurve<Actual_360> curve = ZeroCouponYieldCurve<Actual_360>(actual360, presentDate);
+    curve.addZeroCouponRate(actual360.make_tm(2016, 10, 03), 0.0474);
+    curve.addZeroCouponRate(actual360.make_tm(2017, 04, 03), 0.0500);
+    curve.addZeroCouponRate(actual360.make_tm(2017, 10, 02), 0.0510);
+    curve.computeZeroCurve();
+
+    CurvePublisher<ZeroCouponYieldCurve<Actual_360>> publisher;
+    int reader = publisher.registerReader();
+    publisher.publish(curve);
+
+    // A reader pins the first version while the builder publishes a second one
+    const CurveVersion<ZeroCouponYieldCurve<Actual_360>>* pinned = publisher.pin(reader);
+    publisher.publish(curve);
+
+    if (pinned->version == 1 && publisher.getVersion() == 2 && publisher.getNumberOfRetiredVersions() == 1 &&
+        abs(pinned->curve.getInterpolatedZCRate(1) - curve.getInterpolatedZCRate(1)) <= 1e-12){
+        std::cout << "Pinned curve version survives publication test okay " << endl;
+    }
+
+    // Once the reader releases it, the old version is reclaimed
+    publisher.unpin(reader);
+    if (publisher.reclaim() == 0){
+        std::cout << "Released curve version reclaimed test okay " << endl;
+    }
+    publisher.unregisterReader(reader);
+}
+
+void testCurvePublicationStress(){
+
+    // 4 readers pin the curve in a loop while a builder publishes 2000 versions. Every value of the version n is n,
+    // so a reader seeing a version being built or already deleted would read other values
+    typedef std::vector<double> Curve;
+    CurvePublisher<Curve> publisher;
+    CurveReadGuard<Curve> emptyGuard(publisher, publisher.registerReader());
+    bool emptyRejected = false;
+    try {
+        emptyGuard.getCurve();
+    }
+    catch (const std::logic_error&) {
+        emptyRejected = !emptyGuard.hasCurve() && emptyGuard.getVersion() == 0;
+    }
+
+    int numVersions = 2000;
+    std::atomic<bool> building(true);
+    std::atomic<int> errors(0);
+    std::atomic<long> numReads(0);
+    std::atomic<int> readersReady(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.push_back(std::thread([&publisher, &building, &errors, &numReads, &readersReady](){
+            int slot = publisher.registerReader();
+            readersReady.fetch_add(1);
+            unsigned long lastVersion = 0;
+            while (building.load()) {
+                CurveReadGuard<Curve> guard(publisher, slot);
+                if (!guard.hasCurve()) {
+                    continue;
+                }
+                const Curve& curve = guard.getCurve();
+                for (int i = 0; i < curve.size(); ++i) {
+                    if (curve[i] != guard.getVersion()) {
+                        errors.fetch_add(1);
+                    }
+                }
+                if (guard.getVersion() < lastVersion) {
+                    errors.fetch_add(1);  // The versions seen by a reader never go back
+                }
+                lastVersion = guard.getVersion();
+                numReads.fetch_add(1);
+            }
+            publisher.unregisterReader(slot);
+        }));
+    }
+    while (readersReady.load() < readers.size()) {
+        std::this_thread::yield();
+    }
+    for (int v = 1; v <= numVersions; ++v) {
+        publisher.publish(Curve(256, v));
+    }
+    // On a loaded machine the versions may all be published before a reader is scheduled: let them read the last one
+    while (numReads.load() < readers.size()) {
+        std::this_thread::yield();
+    }
+    building.store(false);
+    for (int r = 0; r < readers.size(); ++r) {
+        readers[r].join();
+    }
+
+    if (emptyRejected && errors.load() == 0 && numReads.load() > 0 && publisher.getVersion() == numVersions &&
+        publisher.reclaim() == 0){
+        std::cout << "Curve publication with concurrent readers test okay " << endl;
+    }
+    else{
+        std::cout << "Curve publication with concurrent readers error: " << emptyRejected << " " << errors.load() << " "
+                  << numReads.load() << " " << publisher.getVersion() << endl;
+    }
+}
+
+void testCurveSnapshotStore(){
+
+    // 3 pillars (6 months, 1 and 2 years) in blocks of 4 days
+    std::string path = "curve_snapshot_test.bin";
+    std::remove(path.c_str());
+    std::vector<int> tenors;
+    tenors.push_back(6);
+    tenors.push_back(12);
+    tenors.push_back(24);
+    CurveSnapshotWriter writer(path, tenors, 4);
+    for (int day = 1; day <= 6; ++day) {
+        std::vector<double> rates(3, 0.04 + 0.001 * day);
+        rates[2] = rates[2] + 0.005;
+        writer.append(DayCountCalculator::make_tm(2016, 04, day), rates);
+    }
+    bool outOfOrderRejected = !writer.append(DayCountCalculator::make_tm(2016, 04, 03), std::vector<double>(3, 0.05)) &&
+                              !writer.append(DayCountCalculator::make_tm(2016, 05, 01), std::vector<double>(2, 0.05));
+
+    // A reader mapped before the writer grows the file only sees the rows inside its mapping until it is refreshed
+    CurveSnapshotStore store(path);
+    for (int day = 7; day <= 20; ++day) {
+        writer.append(DayCountCalculator::make_tm(2016, 04, day), std::vector<double>(3, 0.04 + 0.001 * day));
+    }
+    long long staleRows = store.getNumberOfRows();
+    long long staleRow = store.findRow(DayCountCalculator::make_tm(2016, 04, 18));
+    store.refresh();
+    long long row = store.findRow(DayCountCalculator::make_tm(2016, 04, 18));
+
+    ZeroCouponYieldCurve<Actual_360> curve = store.buildCurve(Actual_360(), 2);
+
+    // A file that is not a store (its header asks for 2^60 pillars) is not opened, and nothing is allocated for it
+    std::string foreignPath = "curve_snapshot_foreign.bin";
+    FILE* foreignFile = std::fopen(foreignPath.c_str(), "wb");
+    long long foreignHeader[4] = {0x4f4e4b4e55, 1LL << 60, 4, 0};
+    std::fwrite(foreignHeader, sizeof(foreignHeader), 1, foreignFile);
+    std::fclose(foreignFile);
+    bool foreignRejected = !CurveSnapshotWriter(foreignPath, tenors, 4).isOpen();
+    std::remove(foreignPath.c_str());
+
+    if (outOfOrderRejected && foreignRejected && staleRows == 8 && staleRow == -1 && store.getNumberOfRows() == 20 && row == 17 &&
+        store.getRate(row, 1) == 0.04 + 0.001 * 18 && writer.getNumberOfRows() == 20 &&
+        abs(curve.getInterpolatedZCRate(curve.getTime(2)) - (0.043 + 0.005)) <= 1e-12){
+        std::cout << "Curve snapshot store test okay " << endl;
+    }
+    else{
+        std::cout << "Curve snapshot store error: " << staleRows << " " << staleRow << " " << row << " " << foreignRejected << endl;
+    }
+    std::remove(path.c_str());
+}
+
+void testIncrementalZeroCurve(){
+
+    Actual_360 actual360 = Actual_360();
+    std::tm presentDate = actual360.make_tm(2016, 04, 01);
+    ZeroCouponYieldCurve<Actual_360> updatedCurve = ZeroCouponYieldCurve<Actual_360>(actual360, presentDate);
+    ZeroCouponYieldCurve<Actual_360> rebuiltCurve = ZeroCouponYieldCurve<Actual_360>(actual360, presentDate);
+    std::vector<std::tm> paymentDates;
+
+    paymentDates.push_back(actual360.make_tm(2016, 10, 03));
+    paymentDates.push_back(actual360.make_tm(2017, 04, 03));
+    paymentDates.push_back(actual360.make_tm(2017, 10, 02));
+    paymentDates.push_back(actual360.make_tm(2018, 04, 02));
+
+    double interestRate[] = {0.0474, 0.0500, 0.0510, 0.0520};
+    double movedInterestRate[] = {0.0474, 0.0500, 0.0530, 0.0520};
+
+    for( int i = 0; i < paymentDates.size(); ++i)
+    {
+        updatedCurve.addZeroCouponRate(paymentDates[i], interestRate[i]);
+        rebuiltCurve.addZeroCouponRate(paymentDates[i], movedInterestRate[i]);
+    }
+    updatedCurve.computeZeroCurve();
+    rebuiltCurve.computeZeroCurve();
+
+    // Move a single pillar and compare with the curve built from scratch
+    unsigned long builtVersion = updatedCurve.getVersion();
+    bool updated = updatedCurve.updateRate(2, 0.0530);
+
+    // Pillars that do not exist, and a curve not computed yet, are rejected without changing the curve
+    unsigned long updatedVersion = updatedCurve.getVersion();
+    ZeroCouponYieldCurve<Actual_360> uncomputedCurve = ZeroCouponYieldCurve<Actual_360>(actual360, presentDate);
+    uncomputedCurve.addZeroCouponRate(paymentDates[0], interestRate[0]);
+    bool rejected = !updatedCurve.updateRate(-1, 0.06) && !updatedCurve.updateRate(4, 0.06) &&
+                    updatedCurve.getVersion() == updatedVersion && !uncomputedCurve.updateRate(0, 0.06);
+
+    bool sameCurve = true;
+    for( int i = 0; i < paymentDates.size(); ++i)
+    {
+        sameCurve = sameCurve && abs(updatedCurve.getForward(i) - rebuiltCurve.getForward(i)) <= 1e-12;
+    }
+    sameCurve = sameCurve && abs(updatedCurve.getInterpolatedZCRate(1.25) - rebuiltCurve.getInterpolatedZCRate(1.25)) <= 1e-12;
+
+    if (sameCurve && updated && rejected && builtVersion != 0 && updatedCurve.getVersion() != builtVersion &&
+        updatedCurve.getVersion() != rebuiltCurve.getVersion()){
+        std::cout << "Zero coupon curve single rate update test okay " << endl;
+    }
+    else{
+        std::cout << "Zero coupon curve single rate update error: " << sameCurve << updated << rejected << endl;
+    }
+}
+
+void testCompoundingConventions(){
+
+    Actual_360 actual360 = Actual_360();
+    std::tm presentDate = actual360.make_tm(2016, 04, 01);
+    ZeroCouponYieldCurve<Actual_360, PeriodicCompounding<2>> semiAnnualCurve =
+            ZeroCouponYieldCurve<Actual_360, PeriodicCompounding<2>>(actual360, presentDate);
+
+    semiAnnualCurve.addZeroCouponRate(actual360.make_tm(2016, 10, 03), 0.0474);
+    semiAnnualCurve.addZeroCouponRate(actual360.make_tm(2017, 04, 03), 0.0500);
+    semiAnnualCurve.addZeroCouponRate(actual360.make_tm(2017, 10, 02), 0.0510);
+    semiAnnualCurve.computeZeroCurve();
+
+    // Semiannual zero rate: P(t0,t) = (1 + R/2)^(-2t)
+    double years = semiAnnualCurve.getTime(1);
+    if (abs(semiAnnualCurve.getDiscountFactor(1) - pow(1 + 0.05 / 2, -2 * years)) <= 1e-12){
+        std::cout << "Periodic compounding discount factor test okay " << endl;
+    }
+
+    // The first forward of a semiannual curve with semiannual periods is the first zero rate
+    if (abs(semiAnnualCurve.getForward(0) - 0.0474) <= 1e-12){
+        std::cout << "Periodic compounding forward rate test okay " << endl;
+    }
+
+    double continuousRate = convertRate<SimpleCompounding, ContinuousCompounding>(0.05, 0.5);
+    if (abs(continuousRate - 2 * log(1 + 0.05 * 0.5)) <= 1e-12 &&
+        convertRate<ContinuousCompounding, ContinuousCompounding>(continuousRate, 0.5) == continuousRate){
+        std::cout << "Compounding conversion test okay " << endl;
+    }
+}
+
+void testCashflowStore(){
+
+    // Swaps and a bond on the zero coupon curve of testValuations
+    Actual_360 actual360 = Actual_360();
+    std::tm presentDate = actual360.make_tm(2016, 04, 01);
+    ZeroCouponYieldCurve<Actual_360> zeroCouponCurve = ZeroCouponYieldCurve<Actual_360>(actual360, presentDate);
+    std::vector<std::tm> paymentDates;
+    paymentDates.push_back(actual360.make_tm(2016, 10, 03));
+    paymentDates.push_back(actual360.make_tm(2017, 04, 03));
+    paymentDates.push_back(actual360.make_tm(2017, 10, 02));
+    paymentDates.push_back(actual360.make_tm(2018, 04, 02));
+    double interestRate[] = {0.0474, 0.0500, 0.0510, 0.0520};
+    for (int i = 0; i < paymentDates.size(); ++i) {
+        zeroCouponCurve.addZeroCouponRate(paymentDates[i], interestRate[i]);
+    }
+    zeroCouponCurve.computeZeroCurve();
+
+    typedef ZeroCouponYieldCurve<Actual_360> ZeroCurve;
+    std::vector<Swap<ZeroCurve>> swaps;
+    swaps.push_back(Swap<ZeroCurve>(100000000, zeroCouponCurve, paymentDates, 0.05));
+    swaps.push_back(Swap<ZeroCurve>(25000000, zeroCouponCurve, paymentDates, 0.045));
+    Bond<ZeroCurve> bond = Bond<ZeroCurve>(1000000, zeroCouponCurve, paymentDates, 0.06);
+
+    CashflowStore store;
+    for (int i = 0; i < swaps.size(); ++i) {
+        int trade = store.addTrade();
+        store.addLeg(trade, swaps[i].getFixPayments(), 1);
+        store.addLeg(trade, swaps[i].getVariablePayments(), -1);
+    }
+    store.addLeg(store.addTrade(), bond.getPaymentVector(), 1);
+    store.setZeroCouponCurve(zeroCouponCurve);
+    std::vector<double> presentValues;
+    store.computePresentValues(presentValues);
+
+    // Same present values as the objects, with the discount factors of the 4 distinct dates only
+    double error = abs(presentValues[0] - swaps[0].computePresentValue()) + abs(presentValues[1] - swaps[1].computePresentValue()) +
+                   abs(presentValues[2] - bond.computePresentValue());
+    double portfolioError = abs(store.computePresentValue() - presentValues[0] - presentValues[1] - presentValues[2]);
+    bool shape = store.getNumberOfTimes() == 4 && store.getNumberOfCashflows() == 20 && store.addCashflow(0, 1, 0.5, 1, 0.05, 1) == -1;
+
+    // A cashflow on a new date has no discount factor until the curve is set again
+    bool wrongSizeRejected = !store.setDiscountFactors(std::vector<double>(3, 1));
+    store.addCashflow(store.addTrade(), 3, 0.5, 1000000, 0.05, 1);
+    std::vector<double> newPresentValues;
+    store.computePresentValues(newPresentValues);
+    bool unsetPoint = std::isnan(newPresentValues[3]) && newPresentValues[0] == presentValues[0];
+    store.setZeroCouponCurve(zeroCouponCurve);
+    store.computePresentValues(newPresentValues);
+    bool setPoint = abs(newPresentValues[3] - 25000 * ZeroCurve::Compounding::discountFactor(zeroCouponCurve.getInterpolatedZCRate(3), 3)) <= 1e-6;
+
+    if (error <= 1e-6 && portfolioError <= 1e-6 && shape && wrongSizeRejected && unsetPoint && setPoint){
+        std::cout << "Cashflow store present value test okay " << endl;
+    }
+    else{
+        std::cout << "Cashflow store present value error: " << error << endl;
+    }
+}
+
+void testBondAnalytics(){
+
+    // A par bond (5% semiannual, 10 years, 5% yield) and a book of random bonds between coupon dates
+    BondAnalytics<PeriodicCompounding<2>> analytics;
+    analytics.addBond(0.05, 2, 10);
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::vector<double> yields;
+    yields.push_back(0.05);
+    for (int i = 0; i < 1000; ++i) {
+        analytics.addBond(0.01 + 0.07 * uniform(generator), (i % 2 == 0) ? 2 : 1, 0.3 + 29.7 * uniform(generator));
+        yields.push_back(0.005 + 0.08 * uniform(generator));
+    }
+    BondResults results;
+    analytics.computeFromYields(yields, results);
+
+    // Yields back from the clean prices
+    std::vector<double> solvedYields;
+    int iterations = analytics.computeYields(results.cleanPrice, solvedYields);
+    double yieldError = 0;
+    for (int i = 0; i < yields.size(); ++i) {
+        yieldError = std::max(yieldError, abs(solvedYields[i] - yields[i]));
+    }
+
+    // Modified duration and convexity against finite differences of the dirty price
+    double bump = 1e-5;
+    std::vector<double> upYields(yields), downYields(yields);
+    for (int i = 0; i < yields.size(); ++i) {
+        upYields[i] = yields[i] + bump;
+        downYields[i] = yields[i] - bump;
+    }
+    BondResults up, down;
+    analytics.computeFromYields(upYields, up);
+    analytics.computeFromYields(downYields, down);
+    double durationError = 0, convexityError = 0;
+    for (int i = 0; i < yields.size(); ++i) {
+        double duration = -(up.dirtyPrice[i] - down.dirtyPrice[i]) / (2 * bump * results.dirtyPrice[i]);
+        double convexity = (up.dirtyPrice[i] - 2 * results.dirtyPrice[i] + down.dirtyPrice[i]) / (bump * bump * results.dirtyPrice[i]);
+        durationError = std::max(durationError, abs(duration - results.modifiedDuration[i]) / results.modifiedDuration[i]);
+        convexityError = std::max(convexityError, abs(convexity - results.convexity[i]) / results.convexity[i]);
+    }
+
+    // A group that is not full (9 bonds: the second group has 7 empty lanes) converges as fast as a full one
+    BondAnalytics<PeriodicCompounding<2>> nineBonds, eightBonds;
+    std::vector<double> ninePrices(9, 100), nineYields, eightYields;
+    for (int i = 0; i < 9; ++i) {
+        nineBonds.addBond(0.05, 2, 1 + i);
+        if (i < 8) {
+            eightBonds.addBond(0.05, 2, 1 + i);
+        }
+    }
+    int nineIterations = nineBonds.computeYields(ninePrices, nineYields);
+    int eightIterations = eightBonds.computeYields(std::vector<double>(8, 100), eightYields);
+
+    if (abs(results.cleanPrice[0] - 100) <= 1e-9 && abs(results.accruedInterest[0]) <= 1e-12 && yieldError <= 1e-10 &&
+        durationError <= 1e-6 && convexityError <= 1e-3 && iterations < 10 && nineIterations == eightIterations &&
+        abs(nineYields[8] - 0.05) <= 1e-12 &&
+        abs(results.modifiedDuration[0] - results.macaulayDuration[0] / 1.025) <= 1e-12){
+        std::cout << "Bond analytics test okay " << endl;
+    }
+    else{
+        std::cout << "Bond analytics error: " << yieldError << " " << durationError << " " << convexityError << " "
+                  << iterations << " " << nineIterations << " " << eightIterations << endl;
+    }
+}
+
+void testCashflowCompression(){
+
+    // Swaps and a bond discounted with two curves (the second one 50 basis points higher) on the same 4 dates
+    Actual_360 actual360 = Actual_360();
+    std::tm presentDate = actual360.make_tm(2016, 04, 01);
+    typedef ZeroCouponYieldCurve<Actual_360> ZeroCurve;
+    ZeroCurve firstCurve = ZeroCurve(actual360, presentDate);
+    ZeroCurve secondCurve = ZeroCurve(actual360, presentDate);
+    std::vector<std::tm> paymentDates;
+    paymentDates.push_back(actual360.make_tm(2016, 10, 03));
+    paymentDates.push_back(actual360.make_tm(2017, 04, 03));
+    paymentDates.push_back(actual360.make_tm(2017, 10, 02));
+    paymentDates.push_back(actual360.make_tm(2018, 04, 02));
+    double interestRate[] = {0.0474, 0.0500, 0.0510, 0.0520};
+    for (int i = 0; i < paymentDates.size(); ++i) {
+        firstCurve.addZeroCouponRate(paymentDates[i], interestRate[i]);
+        secondCurve.addZeroCouponRate(paymentDates[i], interestRate[i] + 0.005);
+    }
+    firstCurve.computeZeroCurve();
+    secondCurve.computeZeroCurve();
+
+    std::vector<Swap<ZeroCurve>> swaps;
+    swaps.push_back(Swap<ZeroCurve>(100000000, firstCurve, paymentDates, 0.05));
+    swaps.push_back(Swap<ZeroCurve>(25000000, firstCurve, paymentDates, 0.045));
+    swaps.push_back(Swap<ZeroCurve>(50000000, secondCurve, paymentDates, 0.055));
+    Bond<ZeroCurve> bond = Bond<ZeroCurve>(1000000, firstCurve, paymentDates, 0.06);
+
+    CashflowStore store;
+    for (int i = 0; i < swaps.size(); ++i) {
+        int trade = store.addTrade();
+        store.addLeg(trade, swaps[i].getFixPayments(), 1, (i == 2) ? 1 : 0);
+        store.addLeg(trade, swaps[i].getVariablePayments(), -1, (i == 2) ? 1 : 0, true);
+    }
+    store.addLeg(store.addTrade(), bond.getPaymentVector(), 1);
+    store.setZeroCouponCurve(firstCurve, 0);
+    store.setZeroCouponCurve(secondCurve, 1);
+    CashflowStore plainStore = store;  // Never compressed
+    std::vector<double> presentValues, compressedValues;
+    plainStore.computePresentValues(presentValues);
+    store.compress();
+    store.computeCompressedPresentValues(compressedValues);
+
+    // 28 cashflows in 8 points (4 dates of 2 curves): the 16 fix ones are compressed in one attribution per trade and
+    // date, and the 12 float ones are kept
+    double error = abs(store.computeCompressedPresentValue() - plainStore.computePresentValue()) +
+                   abs(compressedValues[2] - swaps[2].computePresentValue());
+    for (int i = 0; i < presentValues.size(); ++i) {
+        error = error + abs(compressedValues[i] - presentValues[i]);
+    }
+    bool shape = plainStore.getNumberOfCashflows() == 28 && store.getNumberOfCashflows() == 12 && store.isFloat(0) &&
+                 store.getNumberOfTimes() == 8 && store.getNumberOfAttributions() == 16 &&
+                 store.addCashflow(3, 1, 0.5, 1, 0.05, 1, -1) == -1;
+
+    // Shifted scenario (+10 basis points): new discount factors and forwards, without compressing again
+    ZeroCurve firstShifted = ZeroCurve(actual360, presentDate);
+    ZeroCurve secondShifted = ZeroCurve(actual360, presentDate);
+    for (int i = 0; i < paymentDates.size(); ++i) {
+        firstShifted.addZeroCouponRate(paymentDates[i], interestRate[i] + 0.001);
+        secondShifted.addZeroCouponRate(paymentDates[i], interestRate[i] + 0.006);
+    }
+    firstShifted.computeZeroCurve();
+    secondShifted.computeZeroCurve();
+    std::vector<Swap<ZeroCurve>> shiftedSwaps;
+    shiftedSwaps.push_back(Swap<ZeroCurve>(100000000, firstShifted, paymentDates, 0.05));
+    shiftedSwaps.push_back(Swap<ZeroCurve>(25000000, firstShifted, paymentDates, 0.045));
+    shiftedSwaps.push_back(Swap<ZeroCurve>(50000000, secondShifted, paymentDates, 0.055));
+    for (int i = 0; i < shiftedSwaps.size(); ++i) {
+        std::vector<double> forwards;
+        for (int k = 0; k < shiftedSwaps[i].getVariablePayments().size(); ++k) {
+            forwards.push_back(shiftedSwaps[i].getVariablePayments()[k].getForward());
+        }
+        store.setFloatRates(i, forwards);
+        plainStore.setFloatRates(i, forwards);
+    }
+    store.setZeroCouponCurve(firstShifted, 0);
+    store.setZeroCouponCurve(secondShifted, 1);
+    plainStore.setZeroCouponCurve(firstShifted, 0);
+    plainStore.setZeroCouponCurve(secondShifted, 1);
+    plainStore.computePresentValues(presentValues);
+    store.computeCompressedPresentValues(compressedValues);
+    double shiftedError = abs(store.computeCompressedPresentValue() - plainStore.computePresentValue());
+    for (int i = 0; i < shiftedSwaps.size(); ++i) {
+        shiftedError = shiftedError + abs(compressedValues[i] - shiftedSwaps[i].computePresentValue());
+    }
+    for (int i = 0; i < presentValues.size(); ++i) {
+        shiftedError = shiftedError + abs(compressedValues[i] - presentValues[i]);
+    }
+    bool shifted = store.isCompressed() && !store.setFloatRates(3, std::vector<double>(1, 0.05)) &&
+                   abs(compressedValues[0] - swaps[0].computePresentValue()) > 1000;
+
+    // A trade added after the compression is compressed with the next one, and the previous sums are kept
+    store.addCashflow(store.addTrade(), 1, 0.5, 1000000, 0.05, 1);
+    plainStore.addCashflow(plainStore.addTrade(), 1, 0.5, 1000000, 0.05, 1);
+    store.setZeroCouponCurve(firstShifted, 0);  // The new point has no discount factor yet
+    plainStore.setZeroCouponCurve(firstShifted, 0);
+    double beforeCompression = store.computePresentValue();
+    store.computeCompressedPresentValues(compressedValues);
+    plainStore.computePresentValues(presentValues);
+    double addedError = abs(beforeCompression - plainStore.computePresentValue()) +
+                        abs(store.computeCompressedPresentValue() - plainStore.computePresentValue());
+    for (int i = 0; i < presentValues.size(); ++i) {
+        addedError = addedError + abs(compressedValues[i] - presentValues[i]);
+    }
+
+    if (error <= 1e-6 && shiftedError <= 1e-6 && addedError <= 1e-6 && shape && shifted &&
+        store.getNumberOfCashflows() == 12 && store.getNumberOfAttributions() == 17){
+        std::cout << "Cashflow compression test okay " << endl;
+    }
+    else{
+        std::cout << "Cashflow compression error: " << error << " " << shiftedError << " " << addedError << " " << shape
+                  << shifted << endl;
+    }
+}
+
 void testDiscountFactors(){
 
     // Vector of pointers to store the memory address of the specific instruments
@@ -209,48 +1040,636 @@ void testDiscountFactors(){
     else{
         std::cout << "24month swap discount factor error. The actual value is: " << discountFactor.getDiscountFactor() << endl;
     }
+    for (int i = 0; i < instrumentVector.size(); ++i) {
+        delete instrumentVector[i];
+    }
 }
 
 void buildDiscountFactorCurve(){
 
-    // Vector of pointers to instrument object memory addresses
-    // Each object will be an instrument used to finance the financial institution (build discount factor curve)
+    // Arena with the instruments used to finance the financial institution (build discount factor curve). They are
+    // released together when the arena goes out of scope
+    InstrumentArena instruments;
+
+    // Unordered instruments
+    instruments.addSwap(0.064, 24);
+    instruments.addDeposit(0.05, 6);
+    instruments.addSwap(0.06, 18);
+    instruments.addSwap(0.055, 12);
+
+    // Build the curve: the instruments are sorted by last payment date (compareEntryEndPeriods) and each instrument
+    // gets the curve built with the ones that end before
+    DiscountFactorCurve discountFactorCurve = instruments.bootstrap();
+
+    // Print discount factors
+    cout << "Discount Factor: " << endl;
+    for (int i = 0; i < discountFactorCurve.getIncrement(); ++i) {
+        // DiscountFactor object has overloaded operator <<
+        cout << discountFactorCurve.getDiscountFactor(i) << endl;
+    }
+
+}
+
+void testInstrumentArena(){
+
+    // The same strip as records in an arena and as instrument objects
     std::vector<Instrument *> instrumentVector;
+    InstrumentArena instruments(256);
+    for (int month = 1; month <= 60; ++month) {
+        double rate = 0.03 + 0.0002 * month;
+        if (month <= 3) {
+            instrumentVector.push_back(new Deposit<Actual_360>(rate, month));
+            instruments.addDeposit(rate, month);
+        }
+        else if (month <= 12) {
+            instrumentVector.push_back(new FRA<Actual_360>(rate, month - 3, month));
+            instruments.addFRA(rate, month - 3, month);
+        }
+        else {
+            instrumentVector.push_back(new Swap<Actual_360>(rate, month));
+            instruments.addSwap(rate, month);
+        }
+    }
+    std::reverse(instrumentVector.begin(), instrumentVector.end());
+    DiscountFactorCurve objectCurve = DiscountFactorBootstrap().bootstrap(instrumentVector);
+    DiscountFactorCurve arenaCurve = instruments.bootstrap();
+    for (int i = 0; i < instrumentVector.size(); ++i) {
+        delete instrumentVector[i];
+    }
 
-    // Vector of discountFactor objects:Stores the discount factors of each instrument
-    std::vector<DiscountFactor> discountFactor;
+    double maxError = 0;
+    for (int i = 0; i < objectCurve.getIncrement(); ++i) {
+        maxError = max(maxError, abs(objectCurve.getDiscountFactor(i).getDiscountFactor() - arenaCurve.getDiscountFactor(i).getDiscountFactor()));
+    }
 
-    // Unordered instruments
-    // Create the instruments needed to build the discount factor curve and save them in the instrumentVector
-    instrumentVector.push_back(new Swap<Actual_360>(0.064, 24));
+    // After a release the blocks are reused for the next build
+    int numBlocks = instruments.getNumberOfBlocks();
+    instruments.release();
+    for (int month = 1; month <= 60; ++month) {
+        instruments.addSwap(0.03, month);
+    }
+    if (maxError == 0 && arenaCurve.getIncrement() == 60 && numBlocks > 1 && instruments.getNumberOfBlocks() == numBlocks){
+        std::cout << "Instrument arena bootstrap test okay " << endl;
+    }
+    else{
+        std::cout << "Instrument arena bootstrap error: " << maxError << endl;
+    }
+}
+
+void testIndependentBootstraps(){
+
+    // Two curves (deposit, FRA and swaps) built at the same time, each one in its own thread
+    std::vector<Instrument *> firstInstruments;
+    firstInstruments.push_back(new Swap<Actual_360>(0.064, 24));
+    firstInstruments.push_back(new FRA<Actual_360>(0.052, 6, 12));
+    firstInstruments.push_back(new Deposit<Actual_360>(0.05, 6));
+    firstInstruments.push_back(new Swap<Actual_360>(0.06, 18));
+
+    std::vector<Instrument *> secondInstruments;
+    secondInstruments.push_back(new Deposit<Actual_360>(0.02, 6));
+    secondInstruments.push_back(new FRA<Actual_360>(0.025, 6, 12));
+    secondInstruments.push_back(new Swap<Actual_360>(0.03, 18));
+    secondInstruments.push_back(new Swap<Actual_360>(0.035, 24));
+
+    DiscountFactorBootstrap firstBootstrap, secondBootstrap;
+    DiscountFactorCurve firstCurve, secondCurve;
+    std::thread firstBuilder([&](){ firstCurve = firstBootstrap.bootstrap(firstInstruments);});
+    std::thread secondBuilder([&](){ secondCurve = secondBootstrap.bootstrap(secondInstruments);});
+    firstBuilder.join();
+    secondBuilder.join();
+
+    // The FRA discounts the 6 month discount factor of its own curve (EQUATION 3.10)
+    double firstFra = firstCurve.getDiscountFactor(1).getDiscountFactor();
+    double secondFra = secondCurve.getDiscountFactor(1).getDiscountFactor();
+
+    // Without a curve, the FRA interpolates in its previous discount factors
+    FRA<Actual_360> fra(0.052, 6, 12);
+    vector<DiscountFactor> previousDiscountFactors(1, firstCurve.getDiscountFactor(0));
+    fra.setPreviousDiscountFactors(previousDiscountFactors);
+    double previousFra = fra.getDiscountFactor().getDiscountFactor();
+    if (abs(firstFra - (1 / 1.025) / (1 + 0.052 * 0.5)) <= 1e-12 &&
+        abs(secondFra - (1 / 1.01) / (1 + 0.025 * 0.5)) <= 1e-12 && abs(previousFra - firstFra) <= 1e-12 &&
+        abs(firstCurve.getInterpolatedDiscountFactor(0.5) - 1 / 1.025) <= 1e-12 &&
+        firstCurve.getIncrement() == 4 && secondCurve.getIncrement() == 4){
+        std::cout << "Independent discount factor curves test okay " << endl;
+    }
+    else{
+        std::cout << "Independent discount factor curves error. FRA discount factors: " << firstFra << " " << secondFra << endl;
+    }
+    for (int i = 0; i < firstInstruments.size(); ++i) {
+        delete firstInstruments[i];
+        delete secondInstruments[i];
+    }
+}
+
+void testCurveImage(){
+
+    // Two curves with the same number of points, saved and mapped back
+    InstrumentArena firstInstruments, secondInstruments;
+    for (int month = 6; month <= 36; month = month + 6) {
+        firstInstruments.addSwap(0.03 + 0.001 * month, month);
+        secondInstruments.addSwap(0.02 + 0.001 * month, month);
+    }
+    DiscountFactorCurve firstCurve = firstInstruments.bootstrap();
+    DiscountFactorCurve secondCurve = secondInstruments.bootstrap();
+    std::string firstPath = "curve_image_first.bin", secondPath = "curve_image_second.bin";
+    bool written = CurveImage::writeDiscountFactorCurve(firstPath, firstCurve) &&
+                   CurveImage::writeDiscountFactorCurve(secondPath, secondCurve);
+
+    double maxError = 0;
+    bool versions = false;
+    {
+        MappedCurve firstImage(firstPath), secondImage(secondPath);
+        if (firstImage.isOpen() && secondImage.isOpen()) {
+            for (double years = 0.25; years <= 3; years = years + 0.25) {
+                maxError = max(maxError, abs(firstImage(years) - firstCurve.getInterpolatedDiscountFactor(years)));
+                maxError = max(maxError, abs(secondImage(years) - secondCurve.getInterpolatedDiscountFactor(years)));
+            }
+            // The version identifies the curve, not its size
+            versions = firstImage.getVersion() == firstCurve.getVersion() &&
+                       secondImage.getVersion() == secondCurve.getVersion() &&
+                       firstImage.getVersion() != secondImage.getVersion();
+        }
+    }
+    // Curves without a spline are not saved: a discount factor curve of 2 points (linear) and an empty one
+    InstrumentArena shortInstruments;
+    shortInstruments.addSwap(0.03, 6);
+    shortInstruments.addSwap(0.035, 12);
+    std::string shortPath = "curve_image_short.bin";
+    bool rejected = !CurveImage::writeDiscountFactorCurve(shortPath, shortInstruments.bootstrap()) &&
+                    !CurveImage::writeDiscountFactorCurve(shortPath, DiscountFactorCurve()) &&
+                    !MappedCurve(shortPath).isOpen();
+
+    // Zero coupon yield curve (continuously compounded rates): rates and discount factors read from the image
+    Actual_360 actual360 = Actual_360();
+    std::tm presentDate = actual360.make_tm(2016, 04, 01);
+    ZeroCouponYieldCurve<Actual_360> zeroCouponCurve(actual360, presentDate);
+    zeroCouponCurve.addZeroCouponRate(actual360.make_tm(2016, 10, 03), 0.0474);
+    zeroCouponCurve.addZeroCouponRate(actual360.make_tm(2017, 04, 03), 0.0500);
+    zeroCouponCurve.addZeroCouponRate(actual360.make_tm(2017, 10, 02), 0.0510);
+    zeroCouponCurve.addZeroCouponRate(actual360.make_tm(2018, 04, 02), 0.0520);
+    std::string zeroCouponPath = "curve_image_zero_coupon.bin";
+    rejected = rejected && !CurveImage::writeZeroCouponCurve(zeroCouponPath, zeroCouponCurve);  // Not computed yet
+    zeroCouponCurve.computeZeroCurve();
+    bool zeroCouponWritten = CurveImage::writeZeroCouponCurve(zeroCouponPath, zeroCouponCurve);
+    double zeroCouponError = 1;
+    bool zeroCouponHeader = false;
+    {
+        MappedCurve zeroCouponImage(zeroCouponPath);
+        if (zeroCouponImage.isOpen()) {
+            zeroCouponError = 0;
+            for (double years = 0.25; years <= 2.5; years = years + 0.25) {
+                double rate = zeroCouponCurve.getInterpolatedZCRate(years);
+                zeroCouponError = max(zeroCouponError, abs(zeroCouponImage(years) - rate));
+                zeroCouponError = max(zeroCouponError, abs(zeroCouponImage.getDiscountFactor(years) - exp(-rate * years)));
+            }
+            zeroCouponHeader = zeroCouponImage.getCurveKind() == CurveImageFormat::ZERO_COUPON_RATE &&
+                               zeroCouponImage.getVersion() == zeroCouponCurve.getVersion() &&
+                               zeroCouponImage.getNumberOfKnots() == 4 &&
+                               zeroCouponImage.getNumOfPeriodsPerYear() == zeroCouponCurve.getNumOfPeriodsPerYear();
+        }
+    }
+
+    if (written && versions && maxError <= 1e-15 && rejected && zeroCouponWritten && zeroCouponHeader &&
+        zeroCouponError <= 1e-15){
+        std::cout << "Curve image test okay " << endl;
+    }
+    else{
+        std::cout << "Curve image error: " << written << " " << versions << " " << maxError << " " << rejected << " "
+                  << zeroCouponWritten << " " << zeroCouponHeader << " " << zeroCouponError << endl;
+    }
+    std::remove(firstPath.c_str());
+    std::remove(secondPath.c_str());
+    std::remove(zeroCouponPath.c_str());
+}
+
+void testQuoteReader(){
+
+    // Malformed quotes and a line longer than the read buffer whose tail looks like a quote
+    std::string path = "quote_reader_test.csv";
+    FILE* file = std::fopen(path.c_str(), "wb");
+    std::fputs("type,rate,start_months,end_months\n", file);
+    std::fputs("DEPOSIT,0.05,0,6\n", file);
+    std::fputs("FRA,abc,6,12\n", file);
+    std::fputs("BOND,0.05,0,12\n", file);
+    std::fputs("SWAP,0.055,0\n", file);
+    std::fputs(std::string(100000, ' ').c_str(), file);
+    std::fputs("SWAP,0.09,0,24\n", file);
+    std::fputs("FRA,0.052,6,12\n", file);
+    std::fputs("SWAP,0.06,0,18", file);
+    std::fclose(file);
+
+    QuoteReader<Actual_360> reader(16);
+    bool read = reader.readCsv(path);
+    std::vector<Instrument*>& instruments = reader.getSortedInstruments();
+    bool quotes = instruments.size() == 3 && reader.getNumberOfQuotes() == 3 && reader.getNumberOfRejectedQuotes() == 4 &&
+                  instruments.back()->getNumberOfYearsLastPayment() == 1.5;
+
+    // The same quotes as JSON lines
+    file = std::fopen(path.c_str(), "wb");
+    std::fputs("{\"type\":\"DEPOSIT\",\"rate\":0.05,\"start\":0,\"end\":6}\n", file);
+    std::fputs("{\"type\":\"FRA\",\"rate\":,\"start\":6,\"end\":12}\n", file);
+    std::fputs(std::string(70000, 'x').c_str(), file);
+    std::fputs("{\"type\":\"SWAP\",\"rate\":0.09,\"start\":0,\"end\":24}\n", file);
+    std::fputs("{\"type\":\"FRA\",\"rate\":0.052,\"start\":6,\"end\":12}\n", file);
+    std::fclose(file);
+    QuoteReader<Actual_360> jsonReader(16);
+    bool jsonRead = jsonReader.readJsonLines(path);
+    DiscountFactorCurve curve = jsonReader.bootstrap();
+    std::remove(path.c_str());
+
+    if (read && quotes && jsonRead && jsonReader.getNumberOfQuotes() == 2 && jsonReader.getNumberOfRejectedQuotes() == 2 &&
+        abs(curve.getDiscountFactor(1).getDiscountFactor() - (1 / 1.025) / (1 + 0.052 * 0.5)) <= 1e-12){
+        std::cout << "Quote reader test okay " << endl;
+    }
+    else{
+        std::cout << "Quote reader error: " << reader.getNumberOfQuotes() << " " << reader.getNumberOfRejectedQuotes() << " "
+                  << jsonReader.getNumberOfQuotes() << " " << jsonReader.getNumberOfRejectedQuotes() << endl;
+    }
+}
+
+void testRunningAnnuityBootstrap(){
+
+    // 200 semiannual swaps: the annuity of the curve gives the same discount factors as the summation of EQUATION 3.6
+    std::vector<Instrument *> instrumentVector;
+    instrumentVector.push_back(new Deposit<Actual_360>(0.05, 6));
+    for (int i = 2; i <= 200; ++i) {
+        instrumentVector.push_back(new Swap<Actual_360>(0.05 + 0.0001 * i, 6 * i));
+    }
+    DiscountFactorBootstrap discountFactorBootstrap;
+    DiscountFactorCurve discountFactorCurve = discountFactorBootstrap.bootstrap(instrumentVector);
+
+    std::vector<DiscountFactor> discFact;
+    double maxDifference = 0;
+    for (int i = 0; i < instrumentVector.size(); ++i) {
+        instrumentVector[i]->setPreviousDiscountFactors(discFact);
+        discFact.push_back(instrumentVector[i]->getDiscountFactor());
+        maxDifference = max(maxDifference, abs(discFact[i].getDiscountFactor() - discountFactorCurve.getDiscountFactor(i).getDiscountFactor()));
+    }
+    if (discountFactorCurve.getIncrement() == 200 && maxDifference <= 1e-12){
+        std::cout << "Running annuity bootstrap test okay " << endl;
+    }
+    else{
+        std::cout << "Running annuity bootstrap error. Maximum difference: " << maxDifference << endl;
+    }
+    for (int i = 0; i < instrumentVector.size(); ++i) {
+        delete instrumentVector[i];
+    }
+}
+
+void testGlobalCurveSolver(){
+
+    // The 15x21 FRA reads P(t0,15 months) from a spline that also depends on the 21 and 24 month pillars, so the
+    // sequential bootstrap cannot reprice it. The global solver fits all the pillars at the same time
+    std::vector<Instrument *> instrumentVector;
     instrumentVector.push_back(new Deposit<Actual_360>(0.05, 6));
+    instrumentVector.push_back(new FRA<Actual_360>(0.052, 6, 12));
     instrumentVector.push_back(new Swap<Actual_360>(0.06, 18));
+    instrumentVector.push_back(new FRA<Actual_360>(0.058, 15, 21));
+    instrumentVector.push_back(new Swap<Actual_360>(0.064, 24));
+
+    GlobalDiscountFactorSolver solver = GlobalDiscountFactorSolver();
+    DiscountFactorCurve discountFactorCurve = solver.solve(instrumentVector);
+    double maxResidual = 0;
+    for (int i = 0; i < instrumentVector.size(); ++i) {
+        maxResidual = max(maxResidual, abs(instrumentVector[i]->getParResidual(discountFactorCurve, i)));
+    }
+
+    // Intraday update of the FRA quote: warm start from the previous curve
+    delete instrumentVector[3];
+    instrumentVector[3] = new FRA<Actual_360>(0.0585, 15, 21);
+    GlobalDiscountFactorSolver warmSolver = GlobalDiscountFactorSolver();
+    DiscountFactorCurve updatedCurve = warmSolver.solve(instrumentVector, discountFactorCurve);
+
+    if (solver.hasConverged() && maxResidual <= 1e-12 && solver.getNumberOfIterations() <= 5 &&
+        warmSolver.hasConverged() && abs(instrumentVector[3]->getParResidual(updatedCurve, 3)) <= 1e-12){
+        std::cout << "Global curve solver test okay " << endl;
+    }
+    else{
+        std::cout << "Global curve solver error. Maximum par residual: " << maxResidual << endl;
+    }
+    for (int i = 0; i < instrumentVector.size(); ++i) {
+        delete instrumentVector[i];
+    }
+}
+
+void testCurveBuildScheduler(){
+
+    // 10 currencies, each one with a discount curve and 3 projection curves built over it (40 curves)
+    std::vector<Instrument *> instrumentVector;
+    instrumentVector.push_back(new Deposit<Actual_360>(0.05, 6));
+    for (int i = 2; i <= 200; ++i) {
+        instrumentVector.push_back(new Swap<Actual_360>(0.05 + 0.0001 * i, 6 * i));
+    }
+
+    int numCurrencies = 10;
+    int numProjections = 3;
+    std::vector<DiscountFactorCurve> curves(numCurrencies * (numProjections + 1));
+    std::vector<int> discountIds;
+    CurveBuildScheduler scheduler;
+    for (int c = 0; c < numCurrencies; ++c) {
+        int discount = c * (numProjections + 1);
+        discountIds.push_back(scheduler.addCurve("discount", [&curves, &instrumentVector, discount](){
+            curves[discount] = DiscountFactorBootstrap().bootstrap(instrumentVector);
+        }));
+        for (int p = 1; p <= numProjections; ++p) {
+            scheduler.addCurve("projection", [&curves, &instrumentVector, discount, p](){
+                // The projection build reads the discount curve (it must be built before)
+                if (curves[discount].getIncrement() > 0) {
+                    curves[discount + p] = DiscountFactorBootstrap().bootstrap(instrumentVector);
+                }
+            }, std::vector<int>(1, discountIds.back()));
+        }
+    }
+
+    ThreadPool pool(4);
+    scheduler.run(pool);
+
+    bool dependenciesRespected = true;
+    for (int i = 0; i < scheduler.getNumberOfCurves(); ++i) {
+        int discount = i - i % (numProjections + 1);
+        dependenciesRespected = dependenciesRespected && curves[i].getIncrement() == 200 &&
+                                (i == discount || scheduler.getStartSeconds(i) >= scheduler.getEndSeconds(discount));
+    }
+    std::vector<int> criticalPath = scheduler.getCriticalPath();
+    if (dependenciesRespected && criticalPath.size() == 2 && scheduler.addCurve("cycle", [](){}, std::vector<int>(1, 100)) == -1 &&
+        scheduler.getCriticalPathSeconds() <= scheduler.getRunSeconds()){
+        std::cout << "Curve build scheduler test okay " << endl;
+    }
+    else{
+        std::cout << "Curve build scheduler error. Critical path of " << criticalPath.size() << " curves" << endl;
+    }
+    for (int i = 0; i < instrumentVector.size(); ++i) {
+        delete instrumentVector[i];
+    }
+}
+
+void testQuoteJacobian(){
+
+    // Sensitivity of the 24 month pillar to the 12 month swap quote, against bumping the quote and bootstrapping again
+    std::vector<Instrument *> instrumentVector;
+    instrumentVector.push_back(new Deposit<Actual_360>(0.05, 6));
     instrumentVector.push_back(new Swap<Actual_360>(0.055, 12));
+    instrumentVector.push_back(new Swap<Actual_360>(0.06, 18));
+    instrumentVector.push_back(new Swap<Actual_360>(0.064, 24));
+    QuoteJacobian quoteJacobian;
+    DiscountFactorCurve discountFactorCurve = DiscountFactorBootstrap().bootstrap(instrumentVector, &quoteJacobian);
+
+    double bump = 1e-6;
+    delete instrumentVector[1];
+    instrumentVector[1] = new Swap<Actual_360>(0.055 + bump, 12);
+    DiscountFactorCurve bumpedCurve = DiscountFactorBootstrap().bootstrap(instrumentVector);
+    double bumpedSensitivity = (bumpedCurve.getDiscountFactor(3).getDiscountFactor() -
+                                discountFactorCurve.getDiscountFactor(3).getDiscountFactor()) / bump;
+
+    // Zero rate risk only at the 18 month pillar maps to the zero rate sensitivities of that pillar
+    std::vector<double> zeroRateRisk(4, 0);
+    zeroRateRisk[2] = 1;
+    std::vector<double> quoteRisk = quoteJacobian.mapZeroRateRisk(zeroRateRisk);
+
+    // A FRA that interpolates its start in the spline: the weights against bumping each pillar of the curve by 1
+    Deposit<Actual_360> threeMonths(0.048, 3), sixMonths(0.05, 6);
+    Swap<Actual_360> oneYear(0.055, 12), eighteenMonths(0.06, 18), bumpedOneYear(0.055 + bump, 12);
+    FRA<Actual_360> fra(0.062, 15, 24);
+    std::vector<Instrument *> fraInstruments;
+    fraInstruments.push_back(&threeMonths);
+    fraInstruments.push_back(&sixMonths);
+    fraInstruments.push_back(&oneYear);
+    fraInstruments.push_back(&eighteenMonths);
+    fraInstruments.push_back(&fra);
+    QuoteJacobian fraJacobian;
+    DiscountFactorCurve fraCurve = DiscountFactorBootstrap().bootstrap(fraInstruments, &fraJacobian);
+    fraInstruments[2] = &bumpedOneYear;
+    double fraBumpedSensitivity = (DiscountFactorBootstrap().bootstrap(fraInstruments).getDiscountFactor(4).getDiscountFactor() -
+                                   fraCurve.getDiscountFactor(4).getDiscountFactor()) / bump;
+
+    double maxWeightError = 0;
+    double weightTimes[] = {0.1, 0.3, 0.8, 1.25, 1.5, 2.2};
+    for (int points = 1; points <= fraCurve.getIncrement(); ++points) {
+        DiscountFactorCurve curve;
+        for (int m = 0; m < points; ++m) {
+            curve.addPoint(fraCurve.getTime(m), fraCurve.getDiscountFactor(m).getDiscountFactor());
+        }
+        for (int t = 0; t < 6; ++t) {
+            std::vector<double> weights;
+            curve.getInterpolationWeights(weightTimes[t], weights);
+            for (int j = 0; j < points; ++j) {
+                DiscountFactorCurve bumpedCurve;
+                for (int m = 0; m < points; ++m) {
+                    bumpedCurve.addPoint(curve.getTime(m), curve.getDiscountFactor(m).getDiscountFactor() + (m == j ? 1 : 0));
+                }
+                double weight = bumpedCurve.getInterpolatedDiscountFactor(weightTimes[t]) - curve.getInterpolatedDiscountFactor(weightTimes[t]);
+                maxWeightError = max(maxWeightError, abs(weights[j] - weight));
+            }
+        }
+    }
 
-    // Sort the instruments by last payment date so as to build the curve
-    // Use the bool function defined in Instrument Class
-    std::sort(instrumentVector.begin(), instrumentVector.end(), compareEndPeriods);
+    if (abs(quoteJacobian.getDiscountFactorSensitivity(3, 1) - bumpedSensitivity) <= 1e-5 &&
+        quoteJacobian.getDiscountFactorSensitivity(1, 3) == 0 &&
+        abs(quoteRisk[2] - quoteJacobian.getZeroRateSensitivity(2, 2)) <= 1e-12 &&
+        abs(fraJacobian.getDiscountFactorSensitivity(4, 2) - fraBumpedSensitivity) <= 1e-5 && maxWeightError <= 1e-12){
+        std::cout << "Quote Jacobian test okay " << endl;
+    }
+    else{
+        std::cout << "Quote Jacobian error. Sensitivity: " << quoteJacobian.getDiscountFactorSensitivity(3, 1)
+                  << " bumped: " << bumpedSensitivity << " FRA: " << fraJacobian.getDiscountFactorSensitivity(4, 2)
+                  << " bumped: " << fraBumpedSensitivity << " weights: " << maxWeightError << endl;
+    }
+    for (int i = 0; i < instrumentVector.size(); ++i) {
+        delete instrumentVector[i];
+    }
+}
 
-    // Print discount factors
-    cout << "Discount Factor: " << endl;
+void testPartialRebootstrap(){
+
+    // 200 semiannual swaps: a tick of the 75 year swap only rebuilds the pillars from the 75th year onward
+    std::vector<Instrument *> instrumentVector;
+    instrumentVector.push_back(new Deposit<Actual_360>(0.05, 6));
+    for (int i = 2; i <= 200; ++i) {
+        instrumentVector.push_back(new Swap<Actual_360>(0.05 + 0.0001 * i, 6 * i));
+    }
+    DiscountFactorBootstrap discountFactorBootstrap;
+    DiscountFactorCurve initialCurve = discountFactorBootstrap.bootstrap(instrumentVector);
+
+    Swap<Actual_360> tick = Swap<Actual_360>(0.0651, 6 * 150);
+    const DiscountFactorCurve& updatedCurve = discountFactorBootstrap.update(149, &tick);
+    delete instrumentVector[149];
+    instrumentVector[149] = &tick;
+    DiscountFactorCurve fullCurve = DiscountFactorBootstrap().bootstrap(instrumentVector);
+
+    bool sameCurve = true;
+    for (int i = 0; i < 200; ++i) {
+        double updated = updatedCurve.getDiscountFactor(i).getDiscountFactor();
+        sameCurve = sameCurve && updated == fullCurve.getDiscountFactor(i).getDiscountFactor() &&
+                    (i >= 149 || updated == initialCurve.getDiscountFactor(i).getDiscountFactor());
+    }
+
+    // Ticks with no instrument or another last payment date leave the curve unchanged
+    unsigned long version = updatedCurve.getVersion();
+    Swap<Actual_360> otherMaturity = Swap<Actual_360>(0.0651, 6 * 151);
+    bool rejected = discountFactorBootstrap.update(200, &tick).getVersion() == version &&
+                    discountFactorBootstrap.update(-1, &tick).getVersion() == version &&
+                    discountFactorBootstrap.update(149, &otherMaturity).getVersion() == version;
+
+    // Tick to curve latency of the last swap quote. The bootstrap keeps the last tick, so it lives as long as the
+    // bootstrap is used
+    Swap<Actual_360> lastTick = Swap<Actual_360>(0.07, 6 * 200);
+    for (int i = 0; i < 1000; ++i) {
+        lastTick = Swap<Actual_360>(0.07 + 1e-6 * i, 6 * 200);
+        discountFactorBootstrap.update(199, &lastTick);
+    }
+    LatencyRecorder& latency = discountFactorBootstrap.getUpdateLatency();
+    if (sameCurve && rejected && updatedCurve.getInterpolatedDiscountFactor(75) == fullCurve.getInterpolatedDiscountFactor(75) &&
+        latency.getNumberOfSamples() == 1001 && latency.getP50() <= latency.getP99()){
+        std::cout << "Partial re-bootstrap test okay " << endl;
+    }
+    else{
+        std::cout << "Partial re-bootstrap error: " << sameCurve << rejected << endl;
+    }
+    cout << "Tick to curve latency p50: " << latency.getP50() * 1e6 << " us p99: " << latency.getP99() * 1e6 << " us" << endl;
     for (int i = 0; i < instrumentVector.size(); ++i) {
-        // Set the discount factor vector
-        // The Swap will need them, so it has a function defined that inherits from the one defined in Instrument
-        // The deposit wont need them, so it has no function implemented
-        instrumentVector[i]->setPreviousDiscountFactors(discountFactor);
+        if (i != 149) {
+            delete instrumentVector[i];
+        }
+    }
+}
+
+void testScheduledSwapBootstrap(){
+
+    // Swaps of 1 to 10 years with semiannual payments on the 3rd of April and October (not on the pillars)
+    Actual_360 actual360 = Actual_360();
+    std::tm presentDate = actual360.make_tm(2016, 04, 01);
+    std::vector<Instrument *> instrumentVector;
+    std::vector<ScheduledSwap<Actual_360> *> swaps;
+    instrumentVector.push_back(new Deposit<Actual_360>(0.05, 6));
+    for (int years = 1; years <= 10; ++years) {
+        std::vector<std::tm> paymentDates;
+        for (int k = 1; k <= 2 * years; ++k) {
+            paymentDates.push_back(actual360.make_tm(2016 + k / 2, (k % 2 == 1) ? 10 : 4, 3));
+        }
+        swaps.push_back(new ScheduledSwap<Actual_360>(actual360, 0.05 + 0.001 * years, presentDate, paymentDates));
+        instrumentVector.push_back(swaps.back());
+    }
+    DiscountFactorCurve discountFactorCurve = DiscountFactorBootstrap().bootstrap(instrumentVector);
 
-        // Get the discount factors. Specific function for each object in instrumentVector
-        // The swap needs the previous discount factors so as to compute the one at period n
-        discountFactor.push_back(instrumentVector[i]->getDiscountFactor());
+    // Every swap reprices to par with the log-linear interpolation of the curve pillars
+    double maxResidual = 0;
+    for (int i = 0; i < swaps.size(); ++i) {
+        maxResidual = max(maxResidual, abs(swaps[i]->computeParResidual(discountFactorCurve)));
+    }
+    if (maxResidual <= 1e-14 && discountFactorCurve.getIncrement() == 11){
+        std::cout << "Scheduled swap bootstrap test okay " << endl;
+    }
+    else{
+        std::cout << "Scheduled swap bootstrap error. Maximum par residual: " << maxResidual << endl;
+    }
+    for (int i = 0; i < instrumentVector.size(); ++i) {
+        delete instrumentVector[i];
+    }
+}
 
-        // Build the discount factor curve
-        DiscountFactorBootstrap::addPoint(instrumentVector[i]->getDiscountFactor().getYearsFromPresentValue(),
-                                          instrumentVector[i]->getDiscountFactor().getDiscountFactor());
+void testOISBootstrap(){
 
-        // DiscountFactor object has overloaded operator <<
-        cout << discountFactor[i] << endl;
+    // Overnight fixings of the business days of the last 400 days (the present, day 0, is a Friday)
+    FixingSeries fixings;
+    for (int day = -400; day < 0; ++day) {
+        if (((day % 7) + 7 + 4) % 7 < 5) {
+            fixings.addFixing(day, 0.02 + 0.00002 * (day + 400));
+        }
     }
 
+    // The prefix products give the same growth as compounding the fixings one by one
+    double naiveGrowth = 1;
+    int fixingDay = fixings.getFirstDay();
+    for (int i = 0; i < fixings.getNumberOfFixings(); ++i) {
+        int nextDay = fixingDay + 1;
+        while (nextDay < 0 && ((nextDay % 7) + 7 + 4) % 7 >= 5) {
+            nextDay = nextDay + 1;
+        }
+        if (fixingDay >= -200) {
+            naiveGrowth = naiveGrowth * (1 + fixings.getRate(i) * (nextDay - fixingDay) / 360);
+        }
+        fixingDay = nextDay;
+    }
+    double growthError = abs(fixings.getGrowthFactor(-200, 0) / naiveGrowth - 1);
+
+    // Curve with a deposit, an OIS that started 200 days ago and spot OIS
+    Actual_360 actual360 = Actual_360();
+    std::tm presentDate = actual360.make_tm(2016, 04, 01);
+    std::vector<std::tm> seasonedDates = {actual360.make_tm(2015, 9, 14), actual360.make_tm(2016, 9, 13)};
+    std::vector<OIS<Actual_360> *> swaps;
+    swaps.push_back(new OIS<Actual_360>(actual360, 0.0305, presentDate, seasonedDates, &fixings));
+    double months[] = {12, 24, 36, 60, 120};
+    for (int i = 0; i < 5; ++i) {
+        swaps.push_back(new OIS<Actual_360>(0.03 + 0.001 * i, months[i]));
+    }
+    std::vector<Instrument *> instrumentVector(swaps.begin(), swaps.end());
+    instrumentVector.push_back(new Deposit<Actual_360>(0.03, 1));
+    DiscountFactorCurve discountFactorCurve = DiscountFactorBootstrap().bootstrap(instrumentVector);
+
+    // Every OIS reprices to par
+    double maxPresentValue = 0;
+    for (int i = 0; i < swaps.size(); ++i) {
+        maxPresentValue = max(maxPresentValue, abs(swaps[i]->computePresentValue(discountFactorCurve)));
+    }
+
+    // The telescoped coupon of the second year of the 5 year OIS is the daily compounding of the overnight forwards
+    double dailyGrowth = 1;
+    for (int day = 360; day < 720; ++day) {
+        double forward = (interpolateDiscountFactor<LogLinearDiscountFactorInterpolation>(discountFactorCurve, day / 360.0) /
+                          interpolateDiscountFactor<LogLinearDiscountFactorInterpolation>(discountFactorCurve, (day + 1) / 360.0) - 1) * 360;
+        dailyGrowth = dailyGrowth * (1 + forward / 360);
+    }
+    double couponError = abs(swaps[4]->getCompoundedRate(1, discountFactorCurve) - (dailyGrowth - 1));
+
+    // A coupon that started before the first fixing, and an OIS whose coupons are all paid, are rejected
+    std::vector<std::tm> unfixedDates = {actual360.make_tm(2015, 1, 5), actual360.make_tm(2017, 1, 4)};
+    OIS<Actual_360> unfixed(actual360, 0.03, presentDate, unfixedDates, &fixings);
+    bool unfixedRejected = false;
+    try {
+        unfixed.getDiscountFactor(discountFactorCurve);
+    }
+    catch (const std::invalid_argument&) {
+        unfixedRejected = true;
+    }
+    std::vector<std::tm> paidDates = {actual360.make_tm(2015, 1, 5), actual360.make_tm(2016, 1, 4)};
+    bool paidRejected = false;
+    try {
+        OIS<Actual_360> paid(actual360, 0.03, presentDate, paidDates, &fixings);
+    }
+    catch (const std::invalid_argument&) {
+        paidRejected = true;
+    }
+
+    bool noFixingsRejected = false;
+    try {
+        OIS<Actual_360> noFixings(actual360, 0.0305, presentDate, seasonedDates);
+    }
+    catch (const std::invalid_argument&) {
+        noFixingsRejected = true;
+    }
+
+    // The OIS has no linear par condition: the quote Jacobian is refused instead of dividing by zero
+    bool jacobianRejected = false;
+    QuoteJacobian quoteJacobian;
+    try {
+        DiscountFactorBootstrap().bootstrap(instrumentVector, &quoteJacobian);
+    }
+    catch (const std::invalid_argument&) {
+        jacobianRejected = true;
+    }
+
+    if (growthError <= 1e-13 && maxPresentValue <= 1e-14 && couponError <= 1e-12 && unfixedRejected && paidRejected &&
+        noFixingsRejected && jacobianRejected){
+        std::cout << "OIS bootstrap test okay " << endl;
+    }
+    else{
+        std::cout << "OIS bootstrap error: " << growthError << " " << maxPresentValue << " " << couponError << " "
+                  << unfixedRejected << " " << paidRejected << " " << noFixingsRejected << " " << jacobianRejected << endl;
+    }
+    for (int i = 0; i < instrumentVector.size(); ++i) {
+        delete instrumentVector[i];
+    }
 }
 
 void testsPractice3(){
@@ -312,6 +1731,19 @@ int main() {
     cout<<"Practice 1: Present Date Valuations "<<endl;
     cout<<"----------------------------------------------\n"<<endl;
     testValuations();
+    testMultiCurveValuations();
+    testLazySwapLegs();
+    testSwapAnalytics();
+    testPortfolioValuation();
+    testValuationCache();
+    testCurvePublication();
+    testCurvePublicationStress();
+    testIncrementalZeroCurve();
+    testCurveSnapshotStore();
+    testCompoundingConventions();
+    testCashflowStore();
+    testCashflowCompression();
+    testBondAnalytics();
 
     cout<<"\n"<<endl;
     cout<<"\n----------------------------------------------"<<endl;
@@ -324,6 +1756,17 @@ int main() {
     cout<<"Practice 2: Discount Factor Curve "<<endl;
     cout<<"----------------------------------------------\n"<<endl;
     buildDiscountFactorCurve();
+    testInstrumentArena();
+    testIndependentBootstraps();
+    testCurveImage();
+    testQuoteReader();
+    testRunningAnnuityBootstrap();
+    testGlobalCurveSolver();
+    testCurveBuildScheduler();
+    testQuoteJacobian();
+    testPartialRebootstrap();
+    testScheduledSwapBootstrap();
+    testOISBootstrap();
 
     cout<<"\n"<<endl;
     cout<<"\n----------------------------------------------"<<endl;
@@ -0,0 +1,217 @@
+#ifndef SQF_BONDANALYTICS_H
+#define SQF_BONDANALYTICS_H
+
+#include <Compounding/Compounding.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Results of a batch of bonds (one column per measure, one row per bond). Prices per 100 of nominal
+struct BondResults
+{
+    std::vector<double> dirtyPrice;
+    std::vector<double> cleanPrice;
+    std::vector<double> accruedInterest;
+    std::vector<double> macaulayDuration;  // sum of t*PV / price (years)
+    std::vector<double> modifiedDuration;  // -(1/price) * dPrice/dYield
+    std::vector<double> convexity;         // (1/price) * d2Price/dYield2
+};
+
+// Analytics of a book of fixed coupon bonds with regular schedules: price from yield (clean and dirty), yield from
+// price, Macaulay and modified duration, convexity and accrued interest.
+// The bonds are stored by columns (struct of arrays), and their schedules and year fractions are computed once when
+// they are added: the first coupon time, the number of coupons and the accrued interest. As the coupons are evenly
+// spaced, the discount factor of each coupon is the one of the previous coupon times the discount factor of a period,
+// P(tk+1) = P(tk) * P(1/f), so valuing a bond costs two discount factors (the first coupon and a period), whatever its
+// number of coupons, and one multiplication per coupon.
+// The bonds are valued in groups of LANES with the same instructions for all of them (the loops over the lanes have
+// no branches, so the compiler vectorizes them), including the Newton iterations of the yields, which stop when all
+// the bonds of the group have converged.
+// C: compounding of the yields. It must be exponential in time (PeriodicCompounding or ContinuousCompounding)
+template <class C = PeriodicCompounding<2>>
+class BondAnalytics
+{
+    private:
+        static const int LANES = 8;
+
+        // Bond description columns
+        std::vector<double> coupons;            // Coupon paid each period (per 100 of nominal)
+        std::vector<double> redemptions;        // Paid with the last coupon
+        std::vector<double> periods;            // 1/f in years
+        std::vector<double> firstCouponTimes;   // Years to the next coupon
+        std::vector<double> numCoupons;         // Coupons left (double, to be used in the vectorized loops)
+        std::vector<double> accruedInterests;
+
+        double tolerance;     // Newton tolerance on the dirty price
+        int maxIterations;
+
+        // Sums of a group of bonds from first: S0 = sum of PV, S1 = sum of t*PV, S2 = sum of t^2*PV
+        void sumGroup(int first, const double* yields, double* s0, double* s1, double* s2);
+    public:
+        BondAnalytics();
+
+        // Bond paying couponRate/frequency each period up to its maturity in years (per 100 of nominal). Returns its id
+        int addBond(double couponRate, int frequency, double yearsToMaturity, double redemption = 100);
+
+        void computeFromYields(const std::vector<double>& yields, BondResults& results);
+        // Yields from clean prices. Returns the maximum number of Newton iterations of a group
+        int computeYields(const std::vector<double>& cleanPrices, std::vector<double>& yields);
+
+        int getNumberOfBonds(){ return this->coupons.size();}
+        double getAccruedInterest(int i){ return this->accruedInterests[i];}
+        double getFirstCouponTime(int i){ return this->firstCouponTimes[i];}
+};
+
+template <class C>
+BondAnalytics<C>::BondAnalytics()
+{
+    this->tolerance = 1e-12;
+    this->maxIterations = 50;
+}
+
+template <class C>
+int BondAnalytics<C>::addBond(double couponRate, int frequency, double yearsToMaturity, double redemption)
+{
+    // Schedule back from the maturity: the coupons left and the time to the next one
+    double period = 1.0 / frequency;
+    int coupons = (int)std::ceil(yearsToMaturity * frequency - 1e-9);
+    double firstCouponTime = yearsToMaturity - (coupons - 1) * period;
+
+    this->coupons.push_back(100 * couponRate * period);
+    this->redemptions.push_back(redemption);
+    this->periods.push_back(period);
+    this->firstCouponTimes.push_back(firstCouponTime);
+    this->numCoupons.push_back(coupons);
+    // Part of the current coupon already accrued since the last payment
+    this->accruedInterests.push_back(100 * couponRate * period * (1 - firstCouponTime / period));
+    return this->coupons.size() - 1;
+}
+
+template <class C>
+void BondAnalytics<C>::sumGroup(int first, const double* yields, double* s0, double* s1, double* s2)
+{
+    // Lanes after the last bond are valued as bonds without coupons
+    int numBonds = this->coupons.size();
+    double coupon[LANES], redemption[LANES], period[LANES], time[LANES], count[LANES], discountFactor[LANES], step[LANES];
+    int maxCoupons = 0;
+    for (int l = 0; l < LANES; ++l)
+    {
+        int i = std::min(first + l, numBonds - 1);
+        bool valid = (first + l < numBonds);
+        coupon[l] = this->coupons[i];
+        redemption[l] = this->redemptions[i];
+        period[l] = this->periods[i];
+        time[l] = this->firstCouponTimes[i];
+        count[l] = valid ? this->numCoupons[i] : 0;
+        discountFactor[l] = C::discountFactor(yields[l], time[l]);
+        step[l] = C::discountFactor(yields[l], period[l]);
+        s0[l] = 0;
+        s1[l] = 0;
+        s2[l] = 0;
+        maxCoupons = std::max(maxCoupons, (int)count[l]);
+    }
+
+    for (int k = 0; k < maxCoupons; ++k)
+    {
+        for (int l = 0; l < LANES; ++l)
+        {
+            double amount = (k < count[l]) ? coupon[l] : 0;
+            amount = amount + ((k == count[l] - 1) ? redemption[l] : 0);
+            double presentValue = amount * discountFactor[l];
+            s0[l] = s0[l] + presentValue;
+            s1[l] = s1[l] + time[l] * presentValue;
+            s2[l] = s2[l] + time[l] * time[l] * presentValue;
+            discountFactor[l] = discountFactor[l] * step[l];
+            time[l] = time[l] + period[l];
+        }
+    }
+}
+
+template <class C>
+void BondAnalytics<C>::computeFromYields(const std::vector<double>& yields, BondResults& results)
+{
+    int numBonds = this->coupons.size();
+    results.dirtyPrice.resize(numBonds);
+    results.cleanPrice.resize(numBonds);
+    results.accruedInterest.resize(numBonds);
+    results.macaulayDuration.resize(numBonds);
+    results.modifiedDuration.resize(numBonds);
+    results.convexity.resize(numBonds);
+
+    double groupYields[LANES], s0[LANES], s1[LANES], s2[LANES];
+    for (int first = 0; first < numBonds; first = first + LANES)
+    {
+        for (int l = 0; l < LANES; ++l)
+        {
+            groupYields[l] = yields[std::min(first + l, numBonds - 1)];
+        }
+        this->sumGroup(first, groupYields, s0, s1, s2);
+
+        for (int l = 0; l < LANES && first + l < numBonds; ++l)
+        {
+            // For exponential compoundings dP(t)/dy = -t*h*P(t) and d2P(t)/dy2 = (t^2*h^2 - t*h')*P(t), with h and h'
+            // read from the derivatives of the discount factor of one year
+            int i = first + l;
+            double oneYear = C::discountFactor(groupYields[l], 1);
+            double h = -C::discountFactorDerivative(groupYields[l], 1) / oneYear;
+            double hDerivative = h * h - C::discountFactorSecondDerivative(groupYields[l], 1) / oneYear;
+            results.dirtyPrice[i] = s0[l];
+            results.accruedInterest[i] = this->accruedInterests[i];
+            results.cleanPrice[i] = s0[l] - this->accruedInterests[i];
+            results.macaulayDuration[i] = s1[l] / s0[l];
+            results.modifiedDuration[i] = h * s1[l] / s0[l];
+            results.convexity[i] = (h * h * s2[l] - hDerivative * s1[l]) / s0[l];
+        }
+    }
+}
+
+template <class C>
+int BondAnalytics<C>::computeYields(const std::vector<double>& cleanPrices, std::vector<double>& yields)
+{
+    int numBonds = this->coupons.size();
+    yields.resize(numBonds);
+    int maxGroupIterations = 0;
+
+    double groupYields[LANES], target[LANES], s0[LANES], s1[LANES], s2[LANES];
+    for (int first = 0; first < numBonds; first = first + LANES)
+    {
+        // First guess: the coupon rate. The lanes after the last bond are valued as bonds without coupons (price 0),
+        // so their target is 0 and their residual is always 0
+        for (int l = 0; l < LANES; ++l)
+        {
+            int i = std::min(first + l, numBonds - 1);
+            groupYields[l] = this->coupons[i] / (100 * this->periods[i]);
+            target[l] = (first + l < numBonds) ? cleanPrices[i] + this->accruedInterests[i] : 0;
+        }
+
+        // Newton in lock step: every lane does the same iterations until all of them have converged
+        int iteration = 0;
+        while (iteration < this->maxIterations)
+        {
+            this->sumGroup(first, groupYields, s0, s1, s2);
+            double maxResidual = 0;
+            for (int l = 0; l < LANES; ++l)
+            {
+                double residual = s0[l] - target[l];
+                double h = -C::discountFactorDerivative(groupYields[l], 1) / C::discountFactor(groupYields[l], 1);
+                double derivative = -h * s1[l];
+                groupYields[l] = (derivative != 0) ? groupYields[l] - residual / derivative : groupYields[l];
+                maxResidual = std::max(maxResidual, std::abs(residual));
+            }
+            iteration = iteration + 1;
+            if (maxResidual <= this->tolerance * 100)
+            {
+                break;
+            }
+        }
+        maxGroupIterations = std::max(maxGroupIterations, iteration);
+
+        for (int l = 0; l < LANES && first + l < numBonds; ++l)
+        {
+            yields[first + l] = groupYields[l];
+        }
+    }
+    return maxGroupIterations;
+}
+
+#endif //SQF_BONDANALYTICS_H
@@ -0,0 +1,411 @@
+#ifndef SQF_CASHFLOWSTORE_H
+#define SQF_CASHFLOWSTORE_H
+
+#include <Instrument/Payment/Payment.h>
+#include <DiscountFactorBootstrap/DiscountFactorCurve.h>
+#include <DiscountFactorBootstrap/DiscountFactorInterpolation.h>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+// Cashflows of a whole portfolio stored by columns (struct of arrays) instead of one vector of Payment objects per
+// instrument. The cashflows of each trade are contiguous (tradeOffsets, CSR layout), and the payment times are
+// numbered in a grid of the distinct (curve, time) points, so the present value of the portfolio is:
+// 1. One discount factor per point (setDiscountFactors or the curve setters)
+// 2. A gather of the discount factors of the cashflows and a product by their amounts (one contiguous loop)
+// 3. A segmented sum by trade
+// Each cashflow pays sign * notional * rate * accrual at its payment time (as Payment::value, with sign +1 for the
+// legs received and -1 for the legs paid), discounted with one of the curves of the portfolio (curve ids from 0).
+// Optionally the fix cashflows are compressed (compress): their amounts are summed by point before discounting, so
+// their present value is one product per point instead of one per cashflow, and the present value of each trade is
+// read from a sparse attribution (the amount of each trade in each point, CSR layout). The rows of the compressed
+// cashflows are dropped, so only the attribution is kept in memory. The float cashflows (added with isFloat) are never
+// compressed: their forwards depend on the curve, so they stay as rows and are updated with setFloatRates for each
+// scenario. A new scenario of discount factors (and forwards) does not need to compress again
+class CashflowStore
+{
+    private:
+        // Columns (one row per cashflow)
+        std::vector<int> tradeIds;         // Trade of the cashflow
+        std::vector<int> timeIndices;      // Point of the payment (index in times)
+        std::vector<double> accruals;      // b(t{i-1},ti)
+        std::vector<double> notionals;
+        std::vector<double> rates;         // Fix rate or forward
+        std::vector<double> signs;         // Leg sign: +1 received, -1 paid
+        std::vector<char> floats;          // 1 if the rate is a forward (never compressed)
+
+        std::vector<int> tradeOffsets;     // Cashflows of trade i: [tradeOffsets[i], tradeOffsets[i+1])
+        std::vector<double> times;         // Payment time b(t0,ti) of each point
+        std::vector<int> timeCurves;       // Curve of each point
+        std::vector<std::unordered_map<double, int>> timeIndexOf;  // Point of each payment time, by curve
+        std::vector<double> discountFactors;  // P(t0,ti) of each point, in its curve (NaN until it is set)
+        std::vector<double> values;           // Present value of each cashflow (scratch of the last valuation)
+
+        // Compressed fix cashflows. Their rows are dropped by compress, so these sums are part of the present values
+        // even after more cashflows are added (compressed is false until they are compressed too)
+        bool compressed;
+        std::vector<double> pointAmounts;        // Sum of the amounts of the compressed cashflows of each point
+        std::vector<int> attributionOffsets;     // Attribution of trade i: [attributionOffsets[i], attributionOffsets[i+1])
+        std::vector<int> attributionPoints;
+        std::vector<double> attributionAmounts;  // Sum of the amounts of the compressed cashflows of the trade in the point
+
+        double computeRowsPresentValue();  // Present value of the rows (the ones not compressed)
+    public:
+        CashflowStore();
+
+        int addTrade();  // Returns the id of the trade (the cashflows are added to the last trade)
+        // Returns the row of the cashflow, or -1 if trade is not the last trade added or the curve is negative.
+        // isFloat: the rate is a forward of the curve (it is not compressed, see setFloatRates)
+        int addCashflow(int trade, double payTime, double accrual, double notional, double rate, double sign, int curve = 0,
+                        bool isFloat = false);
+        // Add the payments of a leg of a Swap or a Bond. Returns the number of cashflows added, or -1
+        template <class C>
+        int addLeg(int trade, const std::vector<Payment<C>>& leg, double sign, int curve = 0, bool isFloat = false);
+        // New forwards of the float cashflows of a trade, in the order they were added (for a new scenario of the
+        // curves). Returns false if the number of forwards is not the number of float cashflows of the trade
+        bool setFloatRates(int trade, const std::vector<double>& forwards);
+
+        // Discount factors of the points: given (one per point, as getTime), or read from a curve for the points of
+        // the curve id (all the points if curveId is -1). The points added afterwards have no discount factor (NaN)
+        // until they are set again. Returns false if the number of discount factors is not the number of points
+        bool setDiscountFactors(const std::vector<double>& _discountFactors);
+        template <class Z>
+        void setZeroCouponCurve(const Z& zeroCouponCurve, int curveId = -1);
+        template <class I>
+        void setDiscountFactorCurve(const DiscountFactorCurve& curve, int curveId = -1);
+
+        // Present value of each trade (presentValues is resized to the number of trades) and of the whole portfolio:
+        // the rows and the compressed cashflows, if any
+        void computePresentValues(std::vector<double>& presentValues);
+        double computePresentValue();
+
+        // Sum the amounts of the fix rows by point and by trade and point, and drop those rows. The compressed present
+        // values are the same as the ones of the cashflows (up to the order of the additions)
+        void compress();
+        // Compress the fix rows added since the last compression, if any, and value
+        void computeCompressedPresentValues(std::vector<double>& presentValues);
+        double computeCompressedPresentValue();  // One product per point and one per float row
+        int getNumberOfAttributions(){ return this->attributionPoints.size();}
+        bool isCompressed(){ return this->compressed;}
+
+        int getNumberOfTrades(){ return this->tradeOffsets.size() - 1;}
+        int getNumberOfCashflows(){ return this->tradeIds.size();}  // Rows kept (the compressed ones are dropped)
+        int getNumberOfTimes(){ return this->times.size();}
+        double getTime(int i){ return this->times[i];}
+        int getTimeCurve(int i){ return this->timeCurves[i];}
+        int getTradeId(int row){ return this->tradeIds[row];}
+        bool isFloat(int row){ return this->floats[row] != 0;}
+        int getFirstCashflow(int trade){ return this->tradeOffsets[trade];}
+        int getEndCashflow(int trade){ return this->tradeOffsets[trade + 1];}
+};
+
+CashflowStore::CashflowStore()
+{
+    this->tradeOffsets.push_back(0);
+    this->compressed = false;
+}
+
+int CashflowStore::addTrade()
+{
+    this->compressed = false;
+    this->tradeOffsets.push_back(this->tradeIds.size());
+    return this->tradeOffsets.size() - 2;
+}
+
+int CashflowStore::addCashflow(int trade, double payTime, double accrual, double notional, double rate, double sign, int curve,
+                               bool isFloat)
+{
+    if (trade != this->getNumberOfTrades() - 1 || curve < 0)
+    {
+        return -1;
+    }
+    this->compressed = false;
+
+    // Number the payment time in the grid of distinct (curve, time)
+    if (curve >= this->timeIndexOf.size())
+    {
+        this->timeIndexOf.resize(curve + 1);
+    }
+    std::unordered_map<double, int>::iterator found = this->timeIndexOf[curve].find(payTime);
+    int timeIndex;
+    if (found == this->timeIndexOf[curve].end())
+    {
+        timeIndex = this->times.size();
+        this->timeIndexOf[curve][payTime] = timeIndex;
+        this->times.push_back(payTime);
+        this->timeCurves.push_back(curve);
+        this->discountFactors.push_back(std::numeric_limits<double>::quiet_NaN());
+    }
+    else
+    {
+        timeIndex = found->second;
+    }
+
+    this->tradeIds.push_back(trade);
+    this->timeIndices.push_back(timeIndex);
+    this->accruals.push_back(accrual);
+    this->notionals.push_back(notional);
+    this->rates.push_back(rate);
+    this->signs.push_back(sign);
+    this->floats.push_back(isFloat ? 1 : 0);
+    this->tradeOffsets.back() = this->tradeIds.size();
+    return this->tradeIds.size() - 1;
+}
+
+template <class C>
+int CashflowStore::addLeg(int trade, const std::vector<Payment<C>>& leg, double sign, int curve, bool isFloat)
+{
+    for (int i = 0; i < leg.size(); ++i)
+    {
+        if (this->addCashflow(trade, leg[i].getNumOfYearsFromPresentValue(), leg[i].getDayCountFromLastPayment(),
+                              leg[i].getNominal(), leg[i].getForward(), sign, curve, isFloat) < 0)
+        {
+            return -1;
+        }
+    }
+    return leg.size();
+}
+
+bool CashflowStore::setFloatRates(int trade, const std::vector<double>& forwards)
+{
+    if (trade < 0 || trade >= this->getNumberOfTrades())
+    {
+        return false;
+    }
+    int numFloats = 0;
+    for (int k = this->tradeOffsets[trade]; k < this->tradeOffsets[trade + 1]; ++k)
+    {
+        numFloats = numFloats + this->floats[k];
+    }
+    if (numFloats != forwards.size())
+    {
+        return false;
+    }
+    int next = 0;
+    for (int k = this->tradeOffsets[trade]; k < this->tradeOffsets[trade + 1]; ++k)
+    {
+        if (this->floats[k] != 0)
+        {
+            this->rates[k] = forwards[next];
+            next = next + 1;
+        }
+    }
+    return true;
+}
+
+bool CashflowStore::setDiscountFactors(const std::vector<double>& _discountFactors)
+{
+    if (_discountFactors.size() != this->times.size())
+    {
+        return false;
+    }
+    this->discountFactors = _discountFactors;
+    return true;
+}
+
+template <class Z>
+void CashflowStore::setZeroCouponCurve(const Z& zeroCouponCurve, int curveId)
+{
+    // Discounted as Payment: with the zero coupon rate in the compounding of the curve
+    for (int i = 0; i < this->times.size(); ++i)
+    {
+        if (curveId < 0 || this->timeCurves[i] == curveId)
+        {
+            this->discountFactors[i] = Z::Compounding::discountFactor(zeroCouponCurve.getInterpolatedZCRate(this->times[i]), this->times[i]);
+        }
+    }
+}
+
+template <class I>
+void CashflowStore::setDiscountFactorCurve(const DiscountFactorCurve& curve, int curveId)
+{
+    for (int i = 0; i < this->times.size(); ++i)
+    {
+        if (curveId < 0 || this->timeCurves[i] == curveId)
+        {
+            this->discountFactors[i] = interpolateDiscountFactor<I>(curve, this->times[i]);
+        }
+    }
+}
+
+void CashflowStore::computePresentValues(std::vector<double>& presentValues)
+{
+    // Gather: no branches nor calls, so the compiler can vectorize it
+    int numCashflows = this->tradeIds.size();
+    this->values.resize(numCashflows);
+    const int* timeIndex = this->timeIndices.data();
+    const double* discountFactor = this->discountFactors.data();
+    const double* accrual = this->accruals.data();
+    const double* notional = this->notionals.data();
+    const double* rate = this->rates.data();
+    const double* sign = this->signs.data();
+    double* value = this->values.data();
+    for (int k = 0; k < numCashflows; ++k)
+    {
+        value[k] = sign[k] * notional[k] * rate[k] * accrual[k] * discountFactor[timeIndex[k]];
+    }
+
+    // Segmented sum by trade, and the compressed cashflows of the trade (the trades added after the last compression
+    // have none)
+    int numTrades = this->getNumberOfTrades();
+    int numAttributed = this->attributionOffsets.size() - 1;
+    presentValues.resize(numTrades);
+    const int* point = this->attributionPoints.data();
+    const double* amount = this->attributionAmounts.data();
+    for (int trade = 0; trade < numTrades; ++trade)
+    {
+        double sum = 0;
+        for (int k = this->tradeOffsets[trade]; k < this->tradeOffsets[trade + 1]; ++k)
+        {
+            sum = sum + value[k];
+        }
+        if (trade < numAttributed)
+        {
+            for (int k = this->attributionOffsets[trade]; k < this->attributionOffsets[trade + 1]; ++k)
+            {
+                sum = sum + amount[k] * discountFactor[point[k]];
+            }
+        }
+        presentValues[trade] = sum;
+    }
+}
+
+double CashflowStore::computePresentValue()
+{
+    std::vector<double> presentValues;
+    this->computePresentValues(presentValues);
+    double sum = 0;
+    for (int trade = 0; trade < presentValues.size(); ++trade)
+    {
+        sum = sum + presentValues[trade];
+    }
+    return sum;
+}
+
+void CashflowStore::compress()
+{
+    int numTimes = this->times.size();
+    int numTrades = this->getNumberOfTrades();
+    int numAttributed = this->attributionOffsets.size() - 1;
+    std::vector<int> oldOffsets;
+    std::vector<int> oldPoints;
+    std::vector<double> oldAmounts;
+    oldOffsets.swap(this->attributionOffsets);
+    oldPoints.swap(this->attributionPoints);
+    oldAmounts.swap(this->attributionAmounts);
+    this->attributionOffsets.assign(1, 0);
+
+    // Slot of each point in the attribution of the current trade (-1 if the trade has no cashflow there yet). The
+    // cashflows of a trade are contiguous, so the slots are reset trade by trade. The fix rows are summed into the
+    // attribution (with the one of the previous compression) and the float rows are moved down over them
+    std::vector<int> slotOf(numTimes, -1);
+    int kept = 0;
+    for (int trade = 0; trade < numTrades; ++trade)
+    {
+        int firstSlot = this->attributionPoints.size();
+        if (trade < numAttributed)
+        {
+            for (int k = oldOffsets[trade]; k < oldOffsets[trade + 1]; ++k)
+            {
+                slotOf[oldPoints[k]] = this->attributionPoints.size();
+                this->attributionPoints.push_back(oldPoints[k]);
+                this->attributionAmounts.push_back(oldAmounts[k]);
+            }
+        }
+        int firstKept = kept;
+        for (int k = this->tradeOffsets[trade]; k < this->tradeOffsets[trade + 1]; ++k)
+        {
+            int point = this->timeIndices[k];
+            if (this->floats[k] != 0)
+            {
+                this->tradeIds[kept] = this->tradeIds[k];
+                this->timeIndices[kept] = point;
+                this->accruals[kept] = this->accruals[k];
+                this->notionals[kept] = this->notionals[k];
+                this->rates[kept] = this->rates[k];
+                this->signs[kept] = this->signs[k];
+                this->floats[kept] = 1;
+                kept = kept + 1;
+                continue;
+            }
+            double amount = this->signs[k] * this->notionals[k] * this->rates[k] * this->accruals[k];
+            if (slotOf[point] < 0)
+            {
+                slotOf[point] = this->attributionPoints.size();
+                this->attributionPoints.push_back(point);
+                this->attributionAmounts.push_back(0);
+            }
+            this->attributionAmounts[slotOf[point]] = this->attributionAmounts[slotOf[point]] + amount;
+        }
+        for (int slot = firstSlot; slot < this->attributionPoints.size(); ++slot)
+        {
+            slotOf[this->attributionPoints[slot]] = -1;
+        }
+        this->attributionOffsets.push_back(this->attributionPoints.size());
+        this->tradeOffsets[trade] = firstKept;
+    }
+    this->tradeOffsets[numTrades] = kept;
+
+    // Release the memory of the rows dropped
+    this->tradeIds.resize(kept);
+    this->timeIndices.resize(kept);
+    this->accruals.resize(kept);
+    this->notionals.resize(kept);
+    this->rates.resize(kept);
+    this->signs.resize(kept);
+    this->floats.resize(kept);
+    this->tradeIds.shrink_to_fit();
+    this->timeIndices.shrink_to_fit();
+    this->accruals.shrink_to_fit();
+    this->notionals.shrink_to_fit();
+    this->rates.shrink_to_fit();
+    this->signs.shrink_to_fit();
+    this->floats.shrink_to_fit();
+    this->values.clear();
+    this->values.shrink_to_fit();
+
+    this->pointAmounts.assign(numTimes, 0);
+    for (int k = 0; k < this->attributionPoints.size(); ++k)
+    {
+        this->pointAmounts[this->attributionPoints[k]] = this->pointAmounts[this->attributionPoints[k]] + this->attributionAmounts[k];
+    }
+    this->compressed = true;
+}
+
+void CashflowStore::computeCompressedPresentValues(std::vector<double>& presentValues)
+{
+    if (!this->compressed)
+    {
+        this->compress();
+    }
+    this->computePresentValues(presentValues);
+}
+
+double CashflowStore::computeRowsPresentValue()
+{
+    const int* timeIndex = this->timeIndices.data();
+    const double* discountFactor = this->discountFactors.data();
+    double sum = 0;
+    for (int k = 0; k < this->tradeIds.size(); ++k)
+    {
+        sum = sum + this->signs[k] * this->notionals[k] * this->rates[k] * this->accruals[k] * discountFactor[timeIndex[k]];
+    }
+    return sum;
+}
+
+double CashflowStore::computeCompressedPresentValue()
+{
+    // One product per point for the fix cashflows, whatever their number
+    if (!this->compressed)
+    {
+        this->compress();
+    }
+    double sum = 0;
+    for (int i = 0; i < this->pointAmounts.size(); ++i)
+    {
+        sum = sum + this->pointAmounts[i] * this->discountFactors[i];
+    }
+    return sum + this->computeRowsPresentValue();
+}
+
+#endif //SQF_CASHFLOWSTORE_H
@@ -0,0 +1,87 @@
+#ifndef SQF_COMPOUNDING_H
+#define SQF_COMPOUNDING_H
+
+#include <cmath>
+
+// Compounding conventions of the interest rates. They are used as template parameters (policies), so the conversions
+// between rates and discount factors are resolved at compile time:
+// - growthFactor: value at t of 1 invested at t0 at the given rate (1/P(t0,t))
+// - discountFactor: P(t0,t) for the given rate
+// - rateFromGrowthFactor: rate that gives the growth factor in the given number of years
+// - forwardGrowthFactor: growth factor between t1 and t2 from the rates R(t0,t1) and R(t0,t2)
+// - discountFactorDerivative, discountFactorSecondDerivative: dP/dR and d2P/dR2 (durations and yield solvers)
+
+// Simple interest: 1 + R*b(t0,t) (deposits, forward rates of a single period)
+struct SimpleCompounding
+{
+    static double growthFactor(double rate, double years){ return 1 + rate * years;}
+    static double discountFactor(double rate, double years){ return 1 / (1 + rate * years);}
+    static double rateFromGrowthFactor(double growth, double years){ return (growth - 1) / years;}
+    static double forwardGrowthFactor(double rate1, double years1, double rate2, double years2)
+    {
+        return growthFactor(rate2, years2) / growthFactor(rate1, years1);
+    }
+    static double discountFactorDerivative(double rate, double years){ return -years * pow(discountFactor(rate, years), 2);}
+    static double discountFactorSecondDerivative(double rate, double years)
+    {
+        return 2 * years * years * pow(discountFactor(rate, years), 3);
+    }
+};
+
+// Compounded N times a year: (1 + R/N)^(N*b(t0,t))
+template <int N>
+struct PeriodicCompounding
+{
+    static double growthFactor(double rate, double years){ return pow(1 + rate / N, N * years);}
+    static double discountFactor(double rate, double years){ return pow(1 + rate / N, -N * years);}
+    static double rateFromGrowthFactor(double growth, double years){ return N * (pow(growth, 1 / (N * years)) - 1);}
+    static double forwardGrowthFactor(double rate1, double years1, double rate2, double years2)
+    {
+        return growthFactor(rate2, years2) / growthFactor(rate1, years1);
+    }
+    static double discountFactorDerivative(double rate, double years)
+    {
+        return -years * discountFactor(rate, years) / (1 + rate / N);
+    }
+    static double discountFactorSecondDerivative(double rate, double years)
+    {
+        return years * (years + 1.0 / N) * discountFactor(rate, years) / pow(1 + rate / N, 2);
+    }
+};
+
+// Continuously compounded: exp(R*b(t0,t))
+struct ContinuousCompounding
+{
+    static double growthFactor(double rate, double years){ return exp(rate * years);}
+    static double discountFactor(double rate, double years){ return exp(-rate * years);}
+    static double rateFromGrowthFactor(double growth, double years){ return log(growth) / years;}
+    static double forwardGrowthFactor(double rate1, double years1, double rate2, double years2)
+    {
+        // A single exponential instead of the quotient of two
+        return exp(rate2 * years2 - rate1 * years1);
+    }
+    static double discountFactorDerivative(double rate, double years){ return -years * exp(-rate * years);}
+    static double discountFactorSecondDerivative(double rate, double years){ return years * years * exp(-rate * years);}
+};
+
+// Convert a rate from one compounding convention to another for a period of the given number of years
+template <class FROM, class TO>
+struct RateConversion
+{
+    static double convert(double rate, double years){ return TO::rateFromGrowthFactor(FROM::growthFactor(rate, years), years);}
+};
+
+// Same convention: no conversion at all (the exp/log or pow round trip disappears at compile time)
+template <class C>
+struct RateConversion<C, C>
+{
+    static double convert(double rate, double years){ return rate;}
+};
+
+template <class FROM, class TO>
+double convertRate(double rate, double years)
+{
+    return RateConversion<FROM, TO>::convert(rate, years);
+}
+
+#endif //SQF_COMPOUNDING_H
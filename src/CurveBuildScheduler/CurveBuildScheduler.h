@@ -0,0 +1,188 @@
+#ifndef SQF_CURVEBUILDSCHEDULER_H
+#define SQF_CURVEBUILDSCHEDULER_H
+
+#include <ThreadPool/ThreadPool.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Build a set of curves on a ThreadPool respecting the dependencies between them (e.g. the projection curves of a
+// currency are built once its discount curve is built). The curves form a DAG: a curve can only depend on curves
+// added before it, so there cannot be cycles.
+// A curve is submitted to the pool as soon as the last of its dependencies finishes. After each run the scheduler
+// reports the build latency of every curve and the critical path (the chain of dependent builds that took longest,
+// which bounds the time of the run whatever the number of threads)
+class CurveBuildScheduler
+{
+    public:
+        typedef std::function<void()> CurveBuild;
+
+    private:
+        struct CurveNode
+        {
+            std::string name;
+            CurveBuild build;
+            std::vector<int> dependents;         // Curves waiting for this one
+            int numDependencies;
+            std::atomic<int> remainingDependencies;
+            double startSeconds;                  // Start and end of the build since the run started
+            double endSeconds;
+        };
+
+        std::vector<std::unique_ptr<CurveNode>> curves;
+        std::vector<std::vector<int>> dependencies;
+        std::chrono::steady_clock::time_point runStart;
+        std::mutex doneMutex;
+        std::condition_variable allDone;
+        int numBuilt;
+        double runSeconds;
+
+        std::vector<int> criticalPath;
+        double criticalPathSeconds;
+
+        void buildCurve(ThreadPool& pool, int id);
+        void computeCriticalPath();
+    public:
+        CurveBuildScheduler();
+
+        // Add a curve built by the function. Returns its id, or -1 if a dependency is not a curve added before
+        int addCurve(std::string name, CurveBuild build, std::vector<int> curveDependencies = std::vector<int>());
+
+        // Build every curve and wait for all of them
+        void run(ThreadPool& pool);
+
+        // Report of the last run
+        int getNumberOfCurves(){ return this->curves.size();}
+        std::string getName(int id){ return this->curves[id]->name;}
+        double getBuildSeconds(int id){ return this->curves[id]->endSeconds - this->curves[id]->startSeconds;}
+        double getStartSeconds(int id){ return this->curves[id]->startSeconds;}
+        double getEndSeconds(int id){ return this->curves[id]->endSeconds;}
+        double getRunSeconds(){ return this->runSeconds;}
+        std::vector<int> getCriticalPath(){ return this->criticalPath;}  // Curve ids from the first build to the last
+        double getCriticalPathSeconds(){ return this->criticalPathSeconds;}
+};
+
+CurveBuildScheduler::CurveBuildScheduler()
+{
+    this->numBuilt = 0;
+    this->runSeconds = 0;
+    this->criticalPathSeconds = 0;
+}
+
+int CurveBuildScheduler::addCurve(std::string name, CurveBuild build, std::vector<int> curveDependencies)
+{
+    int id = this->curves.size();
+    for (int i = 0; i < curveDependencies.size(); ++i)
+    {
+        if (curveDependencies[i] < 0 || curveDependencies[i] >= id)
+        {
+            return -1;
+        }
+    }
+
+    std::unique_ptr<CurveNode> node(new CurveNode());
+    node->name = name;
+    node->build = build;
+    node->numDependencies = curveDependencies.size();
+    node->startSeconds = 0;
+    node->endSeconds = 0;
+    for (int i = 0; i < curveDependencies.size(); ++i)
+    {
+        this->curves[curveDependencies[i]]->dependents.push_back(id);
+    }
+    this->curves.push_back(std::move(node));
+    this->dependencies.push_back(curveDependencies);
+    return id;
+}
+
+void CurveBuildScheduler::run(ThreadPool& pool)
+{
+    this->numBuilt = 0;
+    for (int i = 0; i < this->curves.size(); ++i)
+    {
+        this->curves[i]->remainingDependencies.store(this->curves[i]->numDependencies);
+    }
+    this->runStart = std::chrono::steady_clock::now();
+
+    // Submit the curves without dependencies. The rest are submitted by the build of their last dependency
+    for (int i = 0; i < this->curves.size(); ++i)
+    {
+        if (this->curves[i]->numDependencies == 0)
+        {
+            pool.submit([this, &pool, i](){ this->buildCurve(pool, i);});
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(this->doneMutex);
+    this->allDone.wait(lock, [this](){ return this->numBuilt == this->curves.size();});
+    this->runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->runStart).count();
+    lock.unlock();
+
+    this->computeCriticalPath();
+}
+
+void CurveBuildScheduler::buildCurve(ThreadPool& pool, int id)
+{
+    CurveNode& node = *this->curves[id];
+    node.startSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->runStart).count();
+    node.build();
+    node.endSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->runStart).count();
+
+    // The last dependency to finish submits the dependent curve (the atomic decrement also publishes this build)
+    for (int i = 0; i < node.dependents.size(); ++i)
+    {
+        int dependent = node.dependents[i];
+        if (this->curves[dependent]->remainingDependencies.fetch_sub(1) == 1)
+        {
+            pool.submit([this, &pool, dependent](){ this->buildCurve(pool, dependent);});
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(this->doneMutex);
+    this->numBuilt = this->numBuilt + 1;
+    if (this->numBuilt == this->curves.size())
+    {
+        this->allDone.notify_all();
+    }
+}
+
+void CurveBuildScheduler::computeCriticalPath()
+{
+    // Longest chain of build times. The ids are a topological order (dependencies are always added before)
+    int n = this->curves.size();
+    std::vector<double> longest(n);
+    std::vector<int> previous(n, -1);
+    int last = -1;
+    for (int i = 0; i < n; ++i)
+    {
+        longest[i] = 0;
+        for (int j = 0; j < this->dependencies[i].size(); ++j)
+        {
+            int dependency = this->dependencies[i][j];
+            if (previous[i] < 0 || longest[dependency] > longest[i])
+            {
+                longest[i] = longest[dependency];
+                previous[i] = dependency;
+            }
+        }
+        longest[i] = longest[i] + this->getBuildSeconds(i);
+        if (last < 0 || longest[i] > longest[last])
+        {
+            last = i;
+        }
+    }
+
+    this->criticalPath.clear();
+    this->criticalPathSeconds = (last >= 0) ? longest[last] : 0;
+    for (int i = last; i >= 0; i = previous[i])
+    {
+        this->criticalPath.insert(this->criticalPath.begin(), i);
+    }
+}
+
+#endif //SQF_CURVEBUILDSCHEDULER_H
@@ -0,0 +1,248 @@
+#ifndef SQF_CURVEIMAGE_H
+#define SQF_CURVEIMAGE_H
+
+#include <ZeroCouponYieldCurve/ZeroCouponYieldCurve.h>
+#include <DiscountFactorBootstrap/DiscountFactorCurve.h>
+#include <Spline/spline.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Flat binary image of a built curve (knots, spline coefficients and metadata), so a pricing process can map the
+// file and evaluate the curve directly, without bootstrapping or solving the spline again:
+//
+//  | Header | x[n] | y[n] | a[n] | b[n] | c[n] |
+//
+// Between x[i] and x[i+1]: f(x) = a[i]*h^3 + b[i]*h^2 + c[i]*h + y[i] with h = x - x[i]. Beyond the last knot the
+// curve is extrapolated with b[n-1] and c[n-1], and before the first one with the header leftB and leftC (the same
+// representation tk::spline uses). Every field is 8 bytes long, so the arrays are 8-byte aligned
+namespace CurveImageFormat
+{
+    const char MAGIC[8] = {'S', 'Q', 'F', 'C', 'I', 'M', 'G', '1'};
+    const long long FORMAT_VERSION = 1;
+
+    // What the interpolated value of the curve represents
+    const long long ZERO_COUPON_RATE = 0;  // R(t0,t) (ZeroCouponYieldCurve)
+    const long long DISCOUNT_FACTOR = 1;   // P(t0,t) (DiscountFactorCurve)
+
+    struct Header
+    {
+        char magic[8];               // File identifier
+        long long formatVersion;     // Version of the layout
+        long long curveKind;         // ZERO_COUPON_RATE or DISCOUNT_FACTOR
+        long long curveVersion;      // Version of the curve when it was saved
+        long long initialDateKey;    // Date where the curve starts (yyyymmdd, 0 if unknown)
+        long long numKnots;          // Number of knots of the spline
+        double numOfPeriodsPerYear;  // Frequency of the curve pillars (0 if unknown)
+        double leftB;                // Left extrapolation: f(x) = leftB*h^2 + leftC*h + y[0] with h = x - x[0]
+        double leftC;
+    };
+};
+
+namespace CurveImage
+{
+    // Save a spline built on the knots. The coefficients are recovered from the derivatives of the spline, so the
+    // image evaluates exactly as the spline it comes from. Returns false if there are less than 3 knots: the curves
+    // do not solve a spline for them (a DiscountFactorCurve interpolates linearly), so there is nothing to save
+    bool write(std::string path, const tk::spline& spline, const std::vector<double>& knots, CurveImageFormat::Header header)
+    {
+        int n = knots.size();
+        if (n < 3)
+        {
+            return false;
+        }
+        std::vector<double> y(n), a(n), b(n), c(n);
+        for (int i = 0; i < n - 1; ++i)
+        {
+            // Read the polynomial of segment i at its middle point (so the derivatives belong to this segment)
+            double h = 0.5 * (knots[i + 1] - knots[i]);
+            double middle = knots[i] + h;
+            y[i] = spline(knots[i]);
+            a[i] = spline.deriv(3, middle) / 6;
+            b[i] = (spline.deriv(2, middle) - 6 * a[i] * h) / 2;
+            c[i] = spline.deriv(1, middle) - (3 * a[i] * h + 2 * b[i]) * h;
+        }
+
+        // Extrapolation is quadratic at most: f'(x) = 2*b*h + c, so two slopes give b and c
+        double rightSlope1 = spline.deriv(1, knots[n - 1] + 1);
+        double rightSlope2 = spline.deriv(1, knots[n - 1] + 2);
+        y[n - 1] = spline(knots[n - 1]);
+        a[n - 1] = 0;
+        b[n - 1] = (rightSlope2 - rightSlope1) / 2;
+        c[n - 1] = rightSlope1 - 2 * b[n - 1];
+
+        double leftSlope1 = spline.deriv(1, knots[0] - 1);
+        double leftSlope2 = spline.deriv(1, knots[0] - 2);
+        header.leftB = (leftSlope1 - leftSlope2) / 2;
+        header.leftC = leftSlope1 + 2 * header.leftB;
+
+        std::memcpy(header.magic, CurveImageFormat::MAGIC, 8);
+        header.formatVersion = CurveImageFormat::FORMAT_VERSION;
+        header.numKnots = n;
+
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                       std::fwrite(knots.data(), sizeof(double), n, file) == n &&
+                       std::fwrite(y.data(), sizeof(double), n, file) == n &&
+                       std::fwrite(a.data(), sizeof(double), n, file) == n &&
+                       std::fwrite(b.data(), sizeof(double), n, file) == n &&
+                       std::fwrite(c.data(), sizeof(double), n, file) == n;
+        return (std::fclose(file) == 0) && written;
+    }
+
+    // Save a zero coupon yield curve once computeZeroCurve has been called (returns false before, when its version
+    // is still 0)
+    template <class T>
+    bool writeZeroCouponCurve(std::string path, const ZeroCouponYieldCurve<T>& curve)
+    {
+        if (curve.getVersion() == 0)
+        {
+            return false;
+        }
+        std::vector<double> knots;
+        for (int i = 0; i < curve.getNumberOfRates(); ++i)
+        {
+            knots.push_back(curve.getTime(i));
+        }
+        std::tm initialDate = curve.getPresentValue();
+
+        CurveImageFormat::Header header;
+        header.curveKind = CurveImageFormat::ZERO_COUPON_RATE;
+        header.curveVersion = curve.getVersion();
+        header.initialDateKey = (initialDate.tm_year + 1900) * 10000LL + (initialDate.tm_mon + 1) * 100LL + initialDate.tm_mday;
+        header.numOfPeriodsPerYear = curve.getNumOfPeriodsPerYear();
+        return write(path, curve.getSpline(), knots, header);
+    }
+
+    // Save a discount factor curve built by a DiscountFactorBootstrap (returns false if it has less than 3 points)
+    bool writeDiscountFactorCurve(std::string path, const DiscountFactorCurve& curve)
+    {
+        CurveImageFormat::Header header;
+        header.curveKind = CurveImageFormat::DISCOUNT_FACTOR;
+        header.curveVersion = curve.getVersion();
+        header.initialDateKey = 0;
+        header.numOfPeriodsPerYear = 0;
+        return write(path, curve.getSpline(), curve.getTimes(), header);
+    }
+};
+
+// Curve evaluated directly on a mapped image file
+class MappedCurve
+{
+    private:
+        int fileDescriptor;
+        const char* data;                          // Mapped file (nullptr if it could not be mapped)
+        long long mappedSize;
+        const CurveImageFormat::Header* header;
+        const double* x;                           // Knots
+        const double* y;                           // Coefficients of each segment
+        const double* a;
+        const double* b;
+        const double* c;
+    public:
+        MappedCurve(std::string path);
+        ~MappedCurve();
+
+        bool isOpen(){ return this->data != nullptr;}
+        long long getCurveKind(){ return this->header->curveKind;}
+        unsigned long getVersion(){ return this->header->curveVersion;}
+        double getNumOfPeriodsPerYear(){ return this->header->numOfPeriodsPerYear;}
+        int getNumberOfKnots(){ return this->header->numKnots;}
+
+        double operator () (double years) const;  // Interpolated value of the curve (same result as the spline saved)
+        double getDiscountFactor(double years) const;
+};
+
+MappedCurve::MappedCurve(std::string path)
+{
+    this->data = nullptr;
+    this->header = nullptr;
+    this->mappedSize = 0;
+    this->fileDescriptor = open(path.c_str(), O_RDONLY);
+    if (this->fileDescriptor < 0)
+    {
+        return;
+    }
+
+    struct stat fileStatus;
+    if (fstat(this->fileDescriptor, &fileStatus) != 0 || fileStatus.st_size < sizeof(CurveImageFormat::Header))
+    {
+        return;
+    }
+    void* mapped = mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_SHARED, this->fileDescriptor, 0);
+    if (mapped == MAP_FAILED)
+    {
+        return;
+    }
+    this->mappedSize = fileStatus.st_size;
+    this->header = (const CurveImageFormat::Header*)mapped;
+
+    // Check the file is a curve image of this version and it is complete
+    long long n = this->header->numKnots;
+    if (std::memcmp(this->header->magic, CurveImageFormat::MAGIC, 8) != 0 ||
+        this->header->formatVersion != CurveImageFormat::FORMAT_VERSION || n < 2 ||
+        this->mappedSize < sizeof(CurveImageFormat::Header) + 5 * n * sizeof(double))
+    {
+        munmap(mapped, this->mappedSize);
+        return;
+    }
+    this->data = (const char*)mapped;
+    this->x = (const double*)(this->data + sizeof(CurveImageFormat::Header));
+    this->y = this->x + n;
+    this->a = this->y + n;
+    this->b = this->a + n;
+    this->c = this->b + n;
+}
+
+MappedCurve::~MappedCurve()
+{
+    if (this->data != nullptr)
+    {
+        munmap((void*)this->data, this->mappedSize);
+    }
+    if (this->fileDescriptor >= 0)
+    {
+        close(this->fileDescriptor);
+    }
+}
+
+double MappedCurve::operator () (double years) const
+{
+    int n = this->header->numKnots;
+    if (years < this->x[0])
+    {
+        double h = years - this->x[0];
+        return (this->header->leftB * h + this->header->leftC) * h + this->y[0];
+    }
+
+    // Closest knot x[i] < years (as tk::spline, a knot belongs to the segment on its left)
+    int i = std::max(int(std::lower_bound(this->x, this->x + n, years) - this->x) - 1, 0);
+    if (years > this->x[n - 1])
+    {
+        i = n - 1;
+    }
+    double h = years - this->x[i];
+    return ((this->a[i] * h + this->b[i]) * h + this->c[i]) * h + this->y[i];
+}
+
+double MappedCurve::getDiscountFactor(double years) const
+{
+    if (this->header->curveKind == CurveImageFormat::DISCOUNT_FACTOR)
+    {
+        return (*this)(years);
+    }
+    return exp(-(*this)(years) * years);  // Continuously compounded zero coupon rate
+}
+
+#endif //SQF_CURVEIMAGE_H
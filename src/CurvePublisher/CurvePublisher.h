@@ -0,0 +1,226 @@
+#ifndef SQF_CURVEPUBLISHER_H
+#define SQF_CURVEPUBLISHER_H
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// Immutable snapshot of a curve: once published it is never modified, a new version is built instead
+template <class T>
+struct CurveVersion
+{
+    CurveVersion(const T& c, unsigned long v): curve{c}, version{v}{};
+    const T curve;
+    const unsigned long version;
+};
+
+// RCU-style publication of curves, so the pricing threads can keep reading a curve while the market data builder
+// rebuilds it:
+// - The builder assembles a new curve and publishes it by atomically swapping the current pointer
+// - The readers pin the current version without locks (each reader owns a slot where it announces the version it
+//   is reading, as a hazard pointer) and release it when they are done
+// - The old versions are deleted by the builder once no reader slot points to them
+template <class T>
+class CurvePublisher
+{
+    public:
+        static const int MAX_READERS = 64;  // Maximum number of reader slots (threads reading at the same time)
+
+    private:
+        std::atomic<CurveVersion<T>*> current;              // Version the new readers will pin
+        std::atomic<CurveVersion<T>*> pinned[MAX_READERS];  // Version pinned by each reader slot (nullptr if none)
+        std::atomic<bool> slotInUse[MAX_READERS];           // Reader slots already claimed by a thread
+        std::vector<CurveVersion<T>*> retired;              // Old versions waiting for their readers to finish
+        std::atomic<unsigned long> lastVersion;             // Version of the last published curve
+        std::mutex publishMutex;                            // Serializes the builders (readers never take it)
+
+        bool isPinned(CurveVersion<T>* version);
+        int reclaimRetired();
+
+    public:
+        CurvePublisher();
+        ~CurvePublisher();
+
+        // Reader side (lock-free)
+        int registerReader();                          // Claim a reader slot. Returns -1 if all slots are in use
+        void unregisterReader(int slot);
+        const CurveVersion<T>* pin(int slot);          // Pin the current version (nullptr if nothing published)
+        void unpin(int slot);
+
+        // Builder side
+        unsigned long publish(const T& curve);         // Publish a new version of the curve. Returns its version
+        int reclaim();                                 // Delete the retired versions no reader holds
+        unsigned long getVersion();                    // Version of the last published curve (0 if nothing published)
+        int getNumberOfRetiredVersions();
+};
+
+// Pin the current version of a curve for the lifetime of the object
+template <class T>
+class CurveReadGuard
+{
+    private:
+        CurvePublisher<T>& publisher;
+        int slot;
+        const CurveVersion<T>* version;
+    public:
+        CurveReadGuard(CurvePublisher<T>& _publisher, int _slot): publisher(_publisher), slot{_slot}
+        {
+            this->version = this->publisher.pin(this->slot);
+        }
+        ~CurveReadGuard(){ this->publisher.unpin(this->slot);}
+
+        bool hasCurve(){ return this->version != nullptr;}  // False if nothing was published when it was pinned
+        // Throws std::logic_error if nothing was published (see hasCurve)
+        const T& getCurve()
+        {
+            if (this->version == nullptr)
+            {
+                throw std::logic_error("CurveReadGuard: no curve has been published");
+            }
+            return this->version->curve;
+        }
+        unsigned long getVersion(){ return (this->version != nullptr) ? this->version->version : 0;}
+};
+
+template <class T>
+CurvePublisher<T>::CurvePublisher()
+{
+    this->current.store(nullptr);
+    for (int i = 0; i < MAX_READERS; ++i)
+    {
+        this->pinned[i].store(nullptr);
+        this->slotInUse[i].store(false);
+    }
+    this->lastVersion = 0;
+}
+
+template <class T>
+CurvePublisher<T>::~CurvePublisher()
+{
+    // No reader can be alive when the publisher is destroyed
+    delete this->current.load();
+    for (int i = 0; i < this->retired.size(); ++i)
+    {
+        delete this->retired[i];
+    }
+}
+
+template <class T>
+int CurvePublisher<T>::registerReader()
+{
+    for (int i = 0; i < MAX_READERS; ++i)
+    {
+        bool expected = false;
+        if (this->slotInUse[i].compare_exchange_strong(expected, true))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+template <class T>
+void CurvePublisher<T>::unregisterReader(int slot)
+{
+    this->pinned[slot].store(nullptr);
+    this->slotInUse[slot].store(false);
+}
+
+template <class T>
+const CurveVersion<T>* CurvePublisher<T>::pin(int slot)
+{
+    // Announce the version before using it and check it is still the current one: if a builder swapped the pointer
+    // in between, it may not have seen the announcement, so try again with the new version
+    CurveVersion<T>* version = this->current.load();
+    while (true)
+    {
+        this->pinned[slot].store(version);
+        CurveVersion<T>* actual = this->current.load();
+        if (actual == version)
+        {
+            return version;
+        }
+        version = actual;
+    }
+}
+
+template <class T>
+void CurvePublisher<T>::unpin(int slot)
+{
+    this->pinned[slot].store(nullptr);
+}
+
+template <class T>
+unsigned long CurvePublisher<T>::publish(const T& curve)
+{
+    // The new version is fully built before it becomes visible to the readers
+    std::lock_guard<std::mutex> lock(this->publishMutex);
+    unsigned long version = this->lastVersion.load() + 1;
+    CurveVersion<T>* newVersion = new CurveVersion<T>(curve, version);
+    CurveVersion<T>* oldVersion = this->current.exchange(newVersion);
+    this->lastVersion.store(version);
+    if (oldVersion != nullptr)
+    {
+        this->retired.push_back(oldVersion);
+    }
+    this->reclaimRetired();
+    return version;
+}
+
+template <class T>
+bool CurvePublisher<T>::isPinned(CurveVersion<T>* version)
+{
+    for (int i = 0; i < MAX_READERS; ++i)
+    {
+        if (this->pinned[i].load() == version)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <class T>
+int CurvePublisher<T>::reclaim()
+{
+    std::lock_guard<std::mutex> lock(this->publishMutex);
+    return this->reclaimRetired();
+}
+
+template <class T>
+int CurvePublisher<T>::reclaimRetired()
+{
+    // Delete the retired versions no reader holds. The ones still pinned are kept for the next reclaim
+    int alive = 0;
+    for (int i = 0; i < this->retired.size(); ++i)
+    {
+        if (this->isPinned(this->retired[i]))
+        {
+            this->retired[alive] = this->retired[i];
+            alive = alive + 1;
+        }
+        else
+        {
+            delete this->retired[i];
+        }
+    }
+    this->retired.resize(alive);
+    return alive;
+}
+
+template <class T>
+unsigned long CurvePublisher<T>::getVersion()
+{
+    // Read from the counter (the current version could be retired and deleted while it is being read)
+    return this->lastVersion.load();
+}
+
+template <class T>
+int CurvePublisher<T>::getNumberOfRetiredVersions()
+{
+    std::lock_guard<std::mutex> lock(this->publishMutex);
+    return this->retired.size();
+}
+
+#endif //SQF_CURVEPUBLISHER_H
@@ -0,0 +1,116 @@
+#ifndef SQF_CURVEREGISTRY_H
+#define SQF_CURVEREGISTRY_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Identifies a curve by the currency, the index it belongs to and the tenor of that index
+// (e.g. EUR/ESTR/ON for discounting or EUR/EURIBOR/6M for projection)
+struct CurveKey
+{
+    CurveKey(std::string c, std::string i, std::string t): currency{c}, index{i}, tenor{t}{};
+    std::string currency;
+    std::string index;
+    std::string tenor;
+};
+
+// Order the keys so they can be stored in a std::map
+bool operator<(const CurveKey& a, const CurveKey& b)
+{
+    if (a.currency != b.currency) return a.currency < b.currency;
+    if (a.index != b.index) return a.index < b.index;
+    return a.tenor < b.tenor;
+}
+
+// Registry of the curves used to value the instruments. Discount curves (OIS) and forward curves (IBOR tenors) are
+// kept separately, so a swap can discount with one curve and project its float leg with another one.
+// The keys are only compared when a curve is registered or resolved: the instruments resolve the ids once at
+// construction and, from then on, the curves are accessed by position (no string hashing or comparison)
+template <class T>
+class CurveRegistry
+{
+    private:
+        std::map<CurveKey, int> discountCurveIds;  // Key -> position in discountCurves
+        std::map<CurveKey, int> forwardCurveIds;   // Key -> position in forwardCurves
+        std::vector<T> discountCurves;             // Curves used to compute the discount factors P(t0,ti)
+        std::vector<T> forwardCurves;              // Curves used to project the float leg forwards f(t0,ti-1,ti)
+        unsigned long numReplacements;             // Curves replaced under a key already registered
+
+        int addCurve(std::map<CurveKey, int>& ids, std::vector<T>& curves, CurveKey key, T& curve);
+        int getCurveId(std::map<CurveKey, int>& ids, CurveKey key);
+
+    public:
+        CurveRegistry(): numReplacements{0}{};
+
+        // Add (or replace if the key is already registered) a curve. Returns its id
+        int addDiscountCurve(CurveKey key, T& curve);
+        int addForwardCurve(CurveKey key, T& curve);
+
+        // Resolve the id of a curve from its key. Returns -1 if the curve is not registered
+        int getDiscountCurveId(CurveKey key);
+        int getForwardCurveId(CurveKey key);
+
+        // Access a curve by its id (hot path: plain vector indexing)
+        T& getDiscountCurve(int id){ return this->discountCurves[id];}
+        T& getForwardCurve(int id){ return this->forwardCurves[id];}
+
+        int getNumberOfDiscountCurves(){ return this->discountCurves.size();}
+        int getNumberOfForwardCurves(){ return this->forwardCurves.size();}
+        // Changes every time a curve is replaced (the new curve may have the same version as the old one)
+        unsigned long getNumberOfReplacements(){ return this->numReplacements;}
+};
+
+template <class T>
+int CurveRegistry<T>::addCurve(std::map<CurveKey, int>& ids, std::vector<T>& curves, CurveKey key, T& curve)
+{
+    // If the key already exists the curve is replaced in the same position, so the ids already resolved by the
+    // instruments remain valid
+    std::map<CurveKey, int>::iterator it = ids.find(key);
+    if (it != ids.end())
+    {
+        curves[it->second] = curve;
+        this->numReplacements = this->numReplacements + 1;
+        return it->second;
+    }
+    curves.push_back(curve);
+    ids[key] = curves.size() - 1;
+    return curves.size() - 1;
+}
+
+template <class T>
+int CurveRegistry<T>::getCurveId(std::map<CurveKey, int>& ids, CurveKey key)
+{
+    std::map<CurveKey, int>::iterator it = ids.find(key);
+    if (it == ids.end())
+    {
+        return -1;
+    }
+    return it->second;
+}
+
+template <class T>
+int CurveRegistry<T>::addDiscountCurve(CurveKey key, T& curve)
+{
+    return this->addCurve(this->discountCurveIds, this->discountCurves, key, curve);
+}
+
+template <class T>
+int CurveRegistry<T>::addForwardCurve(CurveKey key, T& curve)
+{
+    return this->addCurve(this->forwardCurveIds, this->forwardCurves, key, curve);
+}
+
+template <class T>
+int CurveRegistry<T>::getDiscountCurveId(CurveKey key)
+{
+    return this->getCurveId(this->discountCurveIds, key);
+}
+
+template <class T>
+int CurveRegistry<T>::getForwardCurveId(CurveKey key)
+{
+    return this->getCurveId(this->forwardCurveIds, key);
+}
+
+#endif //SQF_CURVEREGISTRY_H
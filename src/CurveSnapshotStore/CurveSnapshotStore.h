@@ -0,0 +1,471 @@
+#ifndef SQF_CURVESNAPSHOTSTORE_H
+#define SQF_CURVESNAPSHOTSTORE_H
+
+#include <ZeroCouponYieldCurve/ZeroCouponYieldCurve.h>
+#include <Date/DayCountCalculator.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Append-only columnar store of the daily inputs of a zero coupon curve (one rate per pillar), for historical VaR
+// and backtesting. The file can be memory-mapped and read without parsing:
+//
+//  | Header | pillar tenors | block 0 | block 1 | ... |
+//  block: | date column (rowsPerBlock) | pillar 0 rates (rowsPerBlock) | ... | pillar n-1 rates (rowsPerBlock) |
+//
+// The rows (days) are grouped in fixed size blocks so new days can be appended without moving the existing columns.
+// Every field is 8 bytes long, so all the columns are 8-byte aligned. Dates are stored as yyyymmdd integers and the
+// pillars as tenors in months from the curve date
+namespace CurveSnapshotFormat
+{
+    const char MAGIC[8] = {'S', 'Q', 'F', 'C', 'S', 'N', 'P', '1'};
+
+    struct Header
+    {
+        char magic[8];           // File identifier
+        long long numPillars;    // Number of rate columns
+        long long rowsPerBlock;  // Number of days in each block
+        long long numRows;       // Number of days stored (updated last when appending, so readers never see half rows)
+    };
+
+    long long toDateKey(const std::tm& date)
+    {
+        return (date.tm_year + 1900) * 10000LL + (date.tm_mon + 1) * 100LL + date.tm_mday;
+    }
+
+    std::tm fromDateKey(long long key)
+    {
+        return DayCountCalculator::make_tm(key / 10000, (key / 100) % 100, key % 100);
+    }
+
+    // Size in bytes of the header plus the pillar tenors
+    long long getDataOffset(long long numPillars)
+    {
+        return sizeof(Header) + numPillars * sizeof(long long);
+    }
+
+    // Size in bytes of a block of rows
+    long long getBlockSize(long long numPillars, long long rowsPerBlock)
+    {
+        return (1 + numPillars) * rowsPerBlock * sizeof(double);
+    }
+};
+
+// Appends the daily curve inputs at the end of the store
+class CurveSnapshotWriter
+{
+    private:
+        int fileDescriptor;                   // -1 if the file could not be opened
+        CurveSnapshotFormat::Header header;   // Copy of the header of the file
+        long long lastDateKey;                // Dates must be appended in increasing order
+
+        long long getRowOffset(long long row, long long column);
+        bool writeAll(const void* buffer, long long size, long long offset);  // False on a short write
+        bool readAll(void* buffer, long long size, long long offset);
+        void fail();                                                          // Close the file after an error
+    public:
+        // Create the store or open an existing one (then the pillars and block size must match the stored ones)
+        CurveSnapshotWriter(std::string path, std::vector<int> pillarTenorsInMonths, int rowsPerBlock = 256);
+        ~CurveSnapshotWriter();
+
+        bool isOpen(){ return this->fileDescriptor >= 0;}
+        long long getNumberOfRows(){ return this->header.numRows;}
+
+        // Append the rates of a day (one per pillar). Returns false if the date is not after the last one stored, or
+        // if the file could not be written (then the writer is closed and the row is not published)
+        bool append(std::tm date, const std::vector<double>& rates);
+};
+
+// Read-only memory-mapped view of the store
+class CurveSnapshotStore
+{
+    private:
+        int fileDescriptor;
+        const char* data;                    // Mapped file (nullptr if it could not be mapped)
+        long long mappedSize;
+        const CurveSnapshotFormat::Header* header;
+        const long long* pillarTenors;       // Tenor of each pillar in months
+
+        const long long* getDateColumn(long long block);
+        const double* getRateColumn(long long block, long long pillar);
+        bool map();
+        void unmap();
+    public:
+        CurveSnapshotStore(std::string path);
+        ~CurveSnapshotStore();
+
+        bool isOpen(){ return this->data != nullptr;}
+        // Rows published by the writer that are inside the mapping. A writer may append more rows after the store is
+        // mapped: they are only visible after refresh
+        long long getNumberOfRows();
+        bool refresh();  // Map the file again if it has grown. Returns false if it could not be mapped
+        int getNumberOfPillars(){ return this->header->numPillars;}
+        int getPillarTenor(int pillar){ return this->pillarTenors[pillar];}
+
+        // Access the columns in place (no copies)
+        std::tm getDate(long long row);
+        double getRate(long long row, int pillar);
+        long long findRow(std::tm date);     // Row of a date (binary search over the date index). -1 if not stored
+
+        // Build the zero coupon curve of a historical day straight from the mapped columns
+        template <class T>
+        ZeroCouponYieldCurve<T> buildCurve(T dayCountConvention, long long row);
+
+        // Sequential scans: advise the kernel to sequential access and to read the next block ahead of the current one
+        void adviseSequential();
+        void readAhead(long long row);
+        template <class VISITOR>
+        void scan(long long firstRow, long long lastRow, VISITOR& visitor);
+};
+
+// WRITER //
+CurveSnapshotWriter::CurveSnapshotWriter(std::string path, std::vector<int> pillarTenorsInMonths, int rowsPerBlock)
+{
+    this->lastDateKey = 0;
+    this->fileDescriptor = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (this->fileDescriptor < 0)
+    {
+        return;
+    }
+
+    if (this->readAll(&this->header, sizeof(this->header), 0))
+    {
+        // Existing store: check it has the same layout. The pillars are read only once the header is known to be a
+        // store of this layout (the header of another file could ask for any size)
+        bool valid = std::memcmp(this->header.magic, CurveSnapshotFormat::MAGIC, 8) == 0 &&
+                     this->header.numPillars == pillarTenorsInMonths.size() &&
+                     this->header.rowsPerBlock == rowsPerBlock;
+        if (valid)
+        {
+            std::vector<long long> storedTenors(this->header.numPillars);
+            valid = this->readAll(storedTenors.data(), storedTenors.size() * sizeof(long long), sizeof(this->header));
+            for (int i = 0; valid && i < storedTenors.size(); ++i)
+            {
+                valid = valid && (storedTenors[i] == pillarTenorsInMonths[i]);
+            }
+        }
+        if (!valid || (this->header.numRows > 0 &&
+            !this->readAll(&this->lastDateKey, sizeof(long long), this->getRowOffset(this->header.numRows - 1, 0))))
+        {
+            this->fail();
+        }
+        return;
+    }
+
+    // New store: write the header and the pillars
+    std::memcpy(this->header.magic, CurveSnapshotFormat::MAGIC, 8);
+    this->header.numPillars = pillarTenorsInMonths.size();
+    this->header.rowsPerBlock = rowsPerBlock;
+    this->header.numRows = 0;
+    std::vector<long long> tenors(pillarTenorsInMonths.begin(), pillarTenorsInMonths.end());
+    if (!this->writeAll(&this->header, sizeof(this->header), 0) ||
+        !this->writeAll(tenors.data(), tenors.size() * sizeof(long long), sizeof(this->header)))
+    {
+        this->fail();
+    }
+}
+
+CurveSnapshotWriter::~CurveSnapshotWriter()
+{
+    if (this->fileDescriptor >= 0)
+    {
+        close(this->fileDescriptor);
+    }
+}
+
+bool CurveSnapshotWriter::writeAll(const void* buffer, long long size, long long offset)
+{
+    // pwrite may write less than asked (e.g. a full disk): go on from where it stopped, and fail on an error
+    const char* bytes = (const char*)buffer;
+    while (size > 0)
+    {
+        ssize_t written = pwrite(this->fileDescriptor, bytes, size, offset);
+        if (written <= 0)
+        {
+            return false;
+        }
+        bytes = bytes + written;
+        size = size - written;
+        offset = offset + written;
+    }
+    return true;
+}
+
+bool CurveSnapshotWriter::readAll(void* buffer, long long size, long long offset)
+{
+    char* bytes = (char*)buffer;
+    while (size > 0)
+    {
+        ssize_t bytesRead = pread(this->fileDescriptor, bytes, size, offset);
+        if (bytesRead <= 0)
+        {
+            return false;
+        }
+        bytes = bytes + bytesRead;
+        size = size - bytesRead;
+        offset = offset + bytesRead;
+    }
+    return true;
+}
+
+void CurveSnapshotWriter::fail()
+{
+    close(this->fileDescriptor);
+    this->fileDescriptor = -1;
+}
+
+long long CurveSnapshotWriter::getRowOffset(long long row, long long column)
+{
+    // Column 0 is the date index, column i+1 the rates of pillar i
+    long long block = row / this->header.rowsPerBlock;
+    long long rowInBlock = row % this->header.rowsPerBlock;
+    return CurveSnapshotFormat::getDataOffset(this->header.numPillars) +
+           block * CurveSnapshotFormat::getBlockSize(this->header.numPillars, this->header.rowsPerBlock) +
+           (column * this->header.rowsPerBlock + rowInBlock) * sizeof(double);
+}
+
+bool CurveSnapshotWriter::append(std::tm date, const std::vector<double>& rates)
+{
+    long long dateKey = CurveSnapshotFormat::toDateKey(date);
+    if (!this->isOpen() || rates.size() != this->header.numPillars || dateKey <= this->lastDateKey)
+    {
+        return false;
+    }
+
+    // A new block is allocated as a whole, so its columns are contiguous
+    long long row = this->header.numRows;
+    if (row % this->header.rowsPerBlock == 0)
+    {
+        long long blocks = row / this->header.rowsPerBlock + 1;
+        if (ftruncate(this->fileDescriptor, CurveSnapshotFormat::getDataOffset(this->header.numPillars) +
+                      blocks * CurveSnapshotFormat::getBlockSize(this->header.numPillars, this->header.rowsPerBlock)) != 0)
+        {
+            this->fail();
+            return false;
+        }
+    }
+
+    // A row that is not fully written is never published: the number of rows in the file is not updated
+    bool written = this->writeAll(&dateKey, sizeof(long long), this->getRowOffset(row, 0));
+    for (int i = 0; written && i < rates.size(); ++i)
+    {
+        written = this->writeAll(&rates[i], sizeof(double), this->getRowOffset(row, i + 1));
+    }
+
+    // Publish the row by updating the number of rows once its values are written
+    long long numRows = row + 1;
+    if (!written || !this->writeAll(&numRows, sizeof(long long), offsetof(CurveSnapshotFormat::Header, numRows)))
+    {
+        this->fail();
+        return false;
+    }
+    this->header.numRows = numRows;
+    this->lastDateKey = dateKey;
+    return true;
+}
+
+// READER //
+CurveSnapshotStore::CurveSnapshotStore(std::string path)
+{
+    this->data = nullptr;
+    this->header = nullptr;
+    this->pillarTenors = nullptr;
+    this->mappedSize = 0;
+    this->fileDescriptor = open(path.c_str(), O_RDONLY);
+    if (this->fileDescriptor >= 0)
+    {
+        this->map();
+    }
+}
+
+CurveSnapshotStore::~CurveSnapshotStore()
+{
+    this->unmap();
+    if (this->fileDescriptor >= 0)
+    {
+        close(this->fileDescriptor);
+    }
+}
+
+bool CurveSnapshotStore::map()
+{
+    struct stat fileStatus;
+    if (fstat(this->fileDescriptor, &fileStatus) != 0 || fileStatus.st_size < sizeof(CurveSnapshotFormat::Header))
+    {
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_SHARED, this->fileDescriptor, 0);
+    if (mapped == MAP_FAILED)
+    {
+        return false;
+    }
+    this->data = (const char*)mapped;
+    this->mappedSize = fileStatus.st_size;
+    this->header = (const CurveSnapshotFormat::Header*)this->data;
+    this->pillarTenors = (const long long*)(this->data + sizeof(CurveSnapshotFormat::Header));
+
+    // The layout must be valid and the pillar tenors inside the mapping
+    if (std::memcmp(this->header->magic, CurveSnapshotFormat::MAGIC, 8) != 0 || this->header->numPillars <= 0 ||
+        this->header->rowsPerBlock <= 0 || CurveSnapshotFormat::getDataOffset(this->header->numPillars) > this->mappedSize)
+    {
+        this->unmap();
+        return false;
+    }
+    return true;
+}
+
+void CurveSnapshotStore::unmap()
+{
+    if (this->data != nullptr)
+    {
+        munmap((void*)this->data, this->mappedSize);
+    }
+    this->data = nullptr;
+    this->header = nullptr;
+    this->pillarTenors = nullptr;
+    this->mappedSize = 0;
+}
+
+bool CurveSnapshotStore::refresh()
+{
+    struct stat fileStatus;
+    if (this->fileDescriptor < 0 || fstat(this->fileDescriptor, &fileStatus) != 0)
+    {
+        return false;
+    }
+    if (this->data != nullptr && fileStatus.st_size == this->mappedSize)
+    {
+        return true;
+    }
+    this->unmap();
+    return this->map();
+}
+
+long long CurveSnapshotStore::getNumberOfRows()
+{
+    // The writer publishes numRows after growing the file, but this mapping keeps the size the file had when it was
+    // mapped: only the whole blocks inside it can be read
+    if (this->data == nullptr)
+    {
+        return 0;
+    }
+    long long dataOffset = CurveSnapshotFormat::getDataOffset(this->header->numPillars);
+    long long blockSize = CurveSnapshotFormat::getBlockSize(this->header->numPillars, this->header->rowsPerBlock);
+    long long mappedRows = (this->mappedSize - dataOffset) / blockSize * this->header->rowsPerBlock;
+    return std::min(this->header->numRows, mappedRows);
+}
+
+const long long* CurveSnapshotStore::getDateColumn(long long block)
+{
+    return (const long long*)(this->data + CurveSnapshotFormat::getDataOffset(this->header->numPillars) +
+            block * CurveSnapshotFormat::getBlockSize(this->header->numPillars, this->header->rowsPerBlock));
+}
+
+const double* CurveSnapshotStore::getRateColumn(long long block, long long pillar)
+{
+    return (const double*)(this->getDateColumn(block) + (pillar + 1) * this->header->rowsPerBlock);
+}
+
+std::tm CurveSnapshotStore::getDate(long long row)
+{
+    long long block = row / this->header->rowsPerBlock;
+    return CurveSnapshotFormat::fromDateKey(this->getDateColumn(block)[row % this->header->rowsPerBlock]);
+}
+
+double CurveSnapshotStore::getRate(long long row, int pillar)
+{
+    long long block = row / this->header->rowsPerBlock;
+    return this->getRateColumn(block, pillar)[row % this->header->rowsPerBlock];
+}
+
+long long CurveSnapshotStore::findRow(std::tm date)
+{
+    // The dates are appended in increasing order, so the date index is sorted
+    long long dateKey = CurveSnapshotFormat::toDateKey(date);
+    long long first = 0;
+    long long last = this->getNumberOfRows() - 1;
+    while (first <= last)
+    {
+        long long middle = (first + last) / 2;
+        long long middleKey = this->getDateColumn(middle / this->header->rowsPerBlock)[middle % this->header->rowsPerBlock];
+        if (middleKey == dateKey)
+        {
+            return middle;
+        }
+        else if (middleKey < dateKey)
+        {
+            first = middle + 1;
+        }
+        else
+        {
+            last = middle - 1;
+        }
+    }
+    return -1;
+}
+
+template <class T>
+ZeroCouponYieldCurve<T> CurveSnapshotStore::buildCurve(T dayCountConvention, long long row)
+{
+    // The pillar dates are the curve date plus the tenor of each pillar (std::tm normalizes the month overflow when
+    // the day count is computed)
+    std::tm curveDate = this->getDate(row);
+    ZeroCouponYieldCurve<T> curve = ZeroCouponYieldCurve<T>(dayCountConvention, curveDate);
+    long long block = row / this->header->rowsPerBlock;
+    long long rowInBlock = row % this->header->rowsPerBlock;
+    for (int i = 0; i < this->getNumberOfPillars(); ++i)
+    {
+        std::tm pillarDate = curveDate;
+        pillarDate.tm_mon = pillarDate.tm_mon + this->pillarTenors[i];
+        curve.addZeroCouponRate(pillarDate, this->getRateColumn(block, i)[rowInBlock]);
+    }
+    curve.computeZeroCurve();
+    return curve;
+}
+
+void CurveSnapshotStore::adviseSequential()
+{
+    madvise((void*)this->data, this->mappedSize, MADV_SEQUENTIAL);
+}
+
+void CurveSnapshotStore::readAhead(long long row)
+{
+    // Ask the kernel to load the block that follows the one of the row
+    long long nextBlock = row / this->header->rowsPerBlock + 1;
+    long long blockSize = CurveSnapshotFormat::getBlockSize(this->header->numPillars, this->header->rowsPerBlock);
+    long long offset = CurveSnapshotFormat::getDataOffset(this->header->numPillars) + nextBlock * blockSize;
+    long long pageSize = sysconf(_SC_PAGESIZE);
+    long long alignedOffset = offset - offset % pageSize;  // madvise needs a page aligned address
+    if (alignedOffset < this->mappedSize)
+    {
+        long long length = std::min(blockSize + offset - alignedOffset, this->mappedSize - alignedOffset);
+        madvise((void*)(this->data + alignedOffset), length, MADV_WILLNEED);
+    }
+}
+
+template <class VISITOR>
+void CurveSnapshotStore::scan(long long firstRow, long long lastRow, VISITOR& visitor)
+{
+    // Visit the rows in [firstRow, lastRow] in date order: visitor(row) can read the columns through getDate/getRate
+    // or build the curve of the row with buildCurve
+    this->adviseSequential();
+    this->readAhead(firstRow);
+    for (long long row = firstRow; row <= lastRow && row < this->getNumberOfRows(); ++row)
+    {
+        if (row % this->header->rowsPerBlock == 0)
+        {
+            this->readAhead(row);
+        }
+        visitor(row);
+    }
+}
+
+#endif //SQF_CURVESNAPSHOTSTORE_H
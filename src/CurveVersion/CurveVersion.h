@@ -0,0 +1,16 @@
+#ifndef SQF_CURVEVERSION_H
+#define SQF_CURVEVERSION_H
+
+#include <atomic>
+
+// Version of a curve that has just changed (ZeroCouponYieldCurve, DiscountFactorCurve). All the curves draw their
+// versions from this counter, so two curves never have the same version, even if they were built independently with
+// the same number of changes: a curve assigned over another one, or a cache keyed by versions, can not take a curve
+// for another. 0 is never returned (it is the version of an empty curve)
+unsigned long nextCurveVersion()
+{
+    static std::atomic<unsigned long> lastVersion(0);
+    return lastVersion.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+#endif //SQF_CURVEVERSION_H
@@ -1,10 +1,12 @@
 #ifndef SQF_DISCOUNTFACTOR_H
 #define SQF_DISCOUNTFACTOR_H
 
-#include <DiscountFactorBootstrap/DiscountFactorBootstrap.h>
+#include <iostream>
+
+using namespace std;
 
 // Class to create discount factor objects:
-// It actually does not calculate the discount factor(for that we use DiscountFactorBootstrap namespace)
+// It actually does not calculate the discount factor(for that we use DiscountFactorBootstrap class)
 // It is used to create a discount factor object with the info of the instrument for which it was created
 class DiscountFactor
 {
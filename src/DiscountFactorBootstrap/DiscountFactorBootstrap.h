@@ -1,54 +1,153 @@
 #ifndef SQF_DISCOUNTFACTORBOOTSTRAP_H
 #define SQF_DISCOUNTFACTORBOOTSTRAP_H
 
-#include <DiscountFactor/DiscountFactor.h>
-#include <spline/spline.h>
+#include <DiscountFactorBootstrap/DiscountFactorCurve.h>
+#include <DiscountFactorBootstrap/QuoteJacobian.h>
+#include <Instrument/Instrument.h>
+#include <LatencyRecorder/LatencyRecorder.h>
+#include <stdexcept>
 #include <vector>
 #include <algorithm>
-#include <iostream>
 
-using namespace std;
+// Build a discount factor curve from the instruments that finance the institution (deposits, FRAs and swaps).
+// The bootstrap has no global state: the curve is returned as a value and passed explicitly to the instruments that
+// need it (a FRA reads the discount factor at its start date and a swap the running annuity of the curve built so
+// far). Several bootstraps can run at the same time, even on the same instruments, since they are not modified.
+// The bootstrap keeps the instruments and the curve of the last build: when the quote of one instrument ticks, the
+// discount factors of the instruments that end before it do not change, so only the pillars from that instrument
+// onward are built again. The instruments are not owned: they must stay alive while the bootstrap is updated
+class DiscountFactorBootstrap
+{
+    private:
+        std::vector<Instrument*> instruments;  // Instruments of the last bootstrap, sorted by last payment date (not owned)
+        DiscountFactorCurve curve;             // Curve of the last bootstrap
+        LatencyRecorder updateLatency;         // Time from a tick to the updated curve
+
+        void buildFrom(int first);
+        void addQuoteSensitivities(Instrument* instrument, int k, double pillar, const DiscountFactorCurve& curve,
+                                   std::vector<double>& annuitySensitivities, QuoteJacobian& quoteJacobian);
+    public:
+        // If a QuoteJacobian is given, it is filled with dP(t0,tj)/dQuote_i of the curve. Throws std::invalid_argument
+        // if an instrument has no par condition (ScheduledSwap, OIS), since its row cannot be computed
+        DiscountFactorCurve bootstrap(std::vector<Instrument*> _instruments, QuoteJacobian* quoteJacobian = nullptr);
+
+        // Replace the instrument i of the last bootstrap (sorted by last payment date) with one with a new quote and
+        // the same last payment date, and rebuild the curve from its pillar. Returns the updated curve, or the curve
+        // unchanged (same version) if there is no instrument i or the last payment dates differ. The instrument is
+        // kept (not copied) for the next updates, so it must stay alive while the bootstrap is used
+        const DiscountFactorCurve& update(int i, Instrument* instrument);
+
+        const DiscountFactorCurve& getCurve(){ return this->curve;}
+        LatencyRecorder& getUpdateLatency(){ return this->updateLatency;}
+};
 
-// Define a namespace to group the functions related to the discount factor calculation
-// Instead of defining a map, a spline method was downloaded from the internet to set the points of the curve
-// and calculate the interpolation, which is the interest rate for a period (t0,tk) where tk is not a calibrated date
-namespace DiscountFactorBootstrap
+DiscountFactorCurve DiscountFactorBootstrap::bootstrap(std::vector<Instrument*> _instruments, QuoteJacobian* quoteJacobian)
 {
-        vector<double> discountFactorVect;  // Vector to store the discount factors
-        vector<double> discountFactorTime;  // Vector to store the dates
-        tk::spline spline;                  // To interpolate the rates that are not given
-        int increment;                      // Keep track of how many points there are in the discount factor curve
+    // Sort the instruments by last payment date: each discount factor depends on the previous ones
+    this->instruments = _instruments;
+    std::sort(this->instruments.begin(), this->instruments.end(), compareEndPeriods);
 
-        // Add data to the discount curve
-        void addPoint(double time, double discountFactor)
-        {
-            increment = increment +1;  // Number of points the curve has
+    if (quoteJacobian == nullptr)
+    {
+        this->buildFrom(0);
+        return this->curve;
+    }
 
-            // Add elements to the curve
-            discountFactorVect.push_back(discountFactor);
-            discountFactorTime.push_back(time);
+    this->curve.truncate(0);
+    std::vector<double> annuitySensitivities(this->instruments.size(), 0);  // dA(tk)/dQuote_i of the last pillar
+    quoteJacobian->reset(this->instruments.size());
+    for (int i = 0; i < this->instruments.size(); ++i)
+    {
+        DiscountFactor discountFactor = this->instruments[i]->getDiscountFactor(this->curve);
+        quoteJacobian->setPillar(i, discountFactor.getYearsFromPresentValue(), discountFactor.getDiscountFactor());
+        this->addQuoteSensitivities(this->instruments[i], i, discountFactor.getDiscountFactor(), this->curve,
+                                    annuitySensitivities, *quoteJacobian);
+        this->curve.addPoint(discountFactor.getYearsFromPresentValue(), discountFactor.getDiscountFactor());
+    }
+    this->curve.interpolate();
+    return this->curve;
+}
 
-            // To build the discount factor curve at least 3 points are needed (if not we just have a point or a line)
-            if(increment > 2)
-            {
-                tk::spline auxSpline;
-                auxSpline.set_points(discountFactorTime, discountFactorVect);
+void DiscountFactorBootstrap::buildFrom(int first)
+{
+    // Each point is added in O(1) (the spline is solved only if an instrument interpolates), so a curve of swaps is
+    // bootstrapped in O(n)
+    this->curve.truncate(first);
+    for (int i = first; i < this->instruments.size(); ++i)
+    {
+        DiscountFactor discountFactor = this->instruments[i]->getDiscountFactor(this->curve);
+        this->curve.addPoint(discountFactor.getYearsFromPresentValue(), discountFactor.getDiscountFactor());
+    }
+    this->curve.interpolate();
+}
 
-                // Switch pointers so spline is auxSpline
-                std::swap(auxSpline, spline);
-            }
-        };
+const DiscountFactorCurve& DiscountFactorBootstrap::update(int i, Instrument* instrument)
+{
+    // Another last payment date would break the order of the pillars
+    if (i < 0 || i >= this->instruments.size() ||
+        instrument->getNumberOfYearsLastPayment() != this->instruments[i]->getNumberOfYearsLastPayment())
+    {
+        return this->curve;
+    }
+    ScopedLatency latency(this->updateLatency);
+    this->instruments[i] = instrument;
+    this->buildFrom(i);
+    return this->curve;
+}
 
-        // Return the interpolated discount factor once the curve has been build
-        double getInterpolatedDiscountFactor(double timeInYears)
-        {
-            return spline(timeInYears);
-        };
+void DiscountFactorBootstrap::addQuoteSensitivities(Instrument* instrument, int k, double pillar,
+                                                    const DiscountFactorCurve& curve,
+                                                    std::vector<double>& annuitySensitivities,
+                                                    QuoteJacobian& quoteJacobian)
+{
+    // The par condition of the instrument k only involves its own quote and the pillars before it, so the Jacobian
+    // is lower triangular and its row k follows from the rows before (implicit function theorem on the condition):
+    // constant + cP*P(t0,tk) + cA*(A(tk-1) + b(tk-1,tk)*P(t0,tk)) + cI*P(t0,t) = 0
+    ParCondition condition = instrument->getParCondition();
+    ParCondition derivative = instrument->getParConditionQuoteDerivative();
+    double time = instrument->getNumberOfYearsLastPayment();
+    double period = time - curve.getLastTime();
+    double pillarDerivative = condition.discountFactor + condition.annuity * period;
+    if (pillarDerivative == 0)
+    {
+        throw std::invalid_argument("DiscountFactorBootstrap: an instrument of the quote Jacobian has no par condition");
+    }
+
+    std::vector<double> row(k + 1, 0);
+    for (int i = 0; i < k; ++i)
+    {
+        row[i] = -condition.annuity * annuitySensitivities[i];
+    }
 
-        // Get total number of discount factors introduced in the spline
-        int getIncrement()
+    // The interpolated discount factor is linear in the pillars before: dP(t0,t)/dP(t0,tj) are the weights of the
+    // interpolation (one solve of the spline system, instead of one bumped curve per pillar)
+    double interpolated = 0;
+    if (condition.interpolated != 0)
+    {
+        interpolated = curve.getInterpolatedDiscountFactor(condition.interpolationTime);
+        std::vector<double> weights;
+        curve.getInterpolationWeights(condition.interpolationTime, weights);
+        for (int i = 0; i < k; ++i)
         {
-            return increment;
+            double sum = 0;
+            for (int j = i; j < k; ++j)
+            {
+                sum = sum + weights[j] * quoteJacobian(j, i);
+            }
+            row[i] = row[i] - condition.interpolated * sum;
         }
-};
+    }
+
+    // Own quote: derivative of the condition with the pillars fixed
+    double annuity = curve.getAnnuity() + period * pillar;
+    row[k] = -(derivative.constant + derivative.discountFactor * pillar + derivative.annuity * annuity +
+               derivative.interpolated * interpolated);
+
+    for (int i = 0; i <= k; ++i)
+    {
+        quoteJacobian(k, i) = row[i] / pillarDerivative;
+        annuitySensitivities[i] = annuitySensitivities[i] + period * quoteJacobian(k, i);
+    }
+}
+
 #endif //SQF_DISCOUNTFACTORBOOTSTRAP_H
@@ -0,0 +1,211 @@
+#ifndef SQF_DISCOUNTFACTORCURVE_H
+#define SQF_DISCOUNTFACTORCURVE_H
+
+#include <DiscountFactor/DiscountFactor.h>
+#include <Spline/spline.h>
+#include <CurveVersion/CurveVersion.h>
+#include <algorithm>
+#include <vector>
+
+// Discount factor curve P(t0,t) built by a DiscountFactorBootstrap. It is a value: each bootstrap owns its curve, so
+// several curves (one per currency) can be built at the same time, and a built curve can be read from many threads
+// once it is built.
+// A spline method downloaded from the internet is used to interpolate the discount factors between the points. It is
+// solved again only when an interpolation is needed after adding points, so adding n points is O(n) if nothing is
+// interpolated in between (the bootstrap solves it once at the end)
+class DiscountFactorCurve
+{
+    private:
+        std::vector<double> discountFactorVect;  // Discount factors of the points
+        std::vector<double> discountFactorTime;  // Years from present value of the points
+        std::vector<double> annuity;             // Sum of b(t{j-1},tj)*P(t0,tj) for j = 1,...,i (EQUATION 3.6)
+        mutable tk::spline spline;               // To interpolate the discount factors that are not given
+        mutable int splinePoints;                // Number of points the spline was solved with
+        mutable int numSplineSolves;             // Times the spline has been solved (to measure the bootstrap)
+        int increment;                           // Number of points in the curve
+        unsigned long version;                   // Changes every time a point is added or removed (see nextCurveVersion)
+
+        void updateSpline() const;
+    public:
+        DiscountFactorCurve();
+
+        // Add a point at the end of the curve (times must be increasing)
+        void addPoint(double time, double discountFactor);
+        // Keep only the first points (to build the rest of the curve again)
+        void truncate(int numPoints);
+
+        // Interpolated discount factor P(t0,t)
+        double getInterpolatedDiscountFactor(double timeInYears) const;
+        // Weights of the points in the interpolated discount factor: dP(t0,t)/dP(t0,tj). The interpolation is linear in
+        // the discount factors of the points, so they are found with a single solve of the spline system (transposed)
+        void getInterpolationWeights(double timeInYears, std::vector<double>& weights) const;
+
+        // Solve the spline with all the points (after this the curve is not modified when it is read)
+        void interpolate() const;
+
+        // Getters
+        int getIncrement() const { return this->increment;}
+        double getTime(int i) const { return this->discountFactorTime[i];}
+        DiscountFactor getDiscountFactor(int i) const { return DiscountFactor(this->discountFactorTime[i], this->discountFactorVect[i]);}
+        const std::vector<double>& getTimes() const { return this->discountFactorTime;}
+        const tk::spline& getSpline() const { this->updateSpline(); return this->spline;}
+        int getNumberOfSplineSolves() const { return this->numSplineSolves;}
+        // Versions are unique among all the curves: a curve built again never has the version of the one it replaces
+        // (0 for an empty curve)
+        unsigned long getVersion() const { return this->version;}
+
+        // Running annuity of the curve up to the last point: sum of b(t{j-1},tj)*P(t0,tj) (0 if there are no points)
+        double getAnnuity() const { return (this->increment > 0) ? this->annuity.back() : 0;}
+        double getAnnuity(int i) const { return this->annuity[i];}
+        double getLastTime() const { return (this->increment > 0) ? this->discountFactorTime.back() : 0;}
+};
+
+DiscountFactorCurve::DiscountFactorCurve()
+{
+    this->increment = 0;
+    this->splinePoints = 0;
+    this->numSplineSolves = 0;
+    this->version = 0;
+}
+
+void DiscountFactorCurve::addPoint(double time, double discountFactor)
+{
+    // Accumulate the annuity with the period from the previous point, so a swap reads it in O(1)
+    double lastAnnuity = this->getAnnuity();
+    this->annuity.push_back(lastAnnuity + (time - this->getLastTime()) * discountFactor);
+
+    this->increment = this->increment + 1;
+    this->discountFactorVect.push_back(discountFactor);
+    this->discountFactorTime.push_back(time);
+    this->version = nextCurveVersion();
+}
+
+void DiscountFactorCurve::truncate(int numPoints)
+{
+    if (numPoints < this->increment)
+    {
+        this->increment = numPoints;
+        this->discountFactorVect.resize(numPoints);
+        this->discountFactorTime.resize(numPoints);
+        this->annuity.resize(numPoints);
+        this->splinePoints = 0;  // Solved with points that are no longer in the curve
+        this->version = nextCurveVersion();
+    }
+}
+
+void DiscountFactorCurve::updateSpline() const
+{
+    // To build the spline at least 3 points are needed (if not we just have a point or a line)
+    if (this->increment > 2 && this->splinePoints != this->increment)
+    {
+        this->spline.set_points(this->discountFactorTime, this->discountFactorVect);
+        this->splinePoints = this->increment;
+        this->numSplineSolves = this->numSplineSolves + 1;
+    }
+}
+
+void DiscountFactorCurve::interpolate() const
+{
+    this->updateSpline();
+}
+
+double DiscountFactorCurve::getInterpolatedDiscountFactor(double timeInYears) const
+{
+    if (this->increment > 2)
+    {
+        this->updateSpline();
+        return this->spline(timeInYears);
+    }
+
+    // Less than 3 points: linear interpolation between P(t0,t0) = 1 and the points of the curve
+    double lastTime = 0;
+    double lastDiscountFactor = 1;
+    for (int i = 0; i < this->increment; ++i)
+    {
+        if (timeInYears <= this->discountFactorTime[i] || i == this->increment - 1)
+        {
+            double slope = (this->discountFactorVect[i] - lastDiscountFactor) / (this->discountFactorTime[i] - lastTime);
+            return lastDiscountFactor + slope * (timeInYears - lastTime);
+        }
+        lastTime = this->discountFactorTime[i];
+        lastDiscountFactor = this->discountFactorVect[i];
+    }
+    return 1;
+}
+
+void DiscountFactorCurve::getInterpolationWeights(double timeInYears, std::vector<double>& weights) const
+{
+    int n = this->increment;
+    const std::vector<double>& x = this->discountFactorTime;
+    weights.assign(n, 0);
+    if (n == 0)
+    {
+        return;
+    }
+
+    if (n <= 2)
+    {
+        // Linear interpolation between P(t0,t0) = 1 (not a point of the curve) and the points
+        int i = (n == 2 && timeInYears > x[0]) ? 1 : 0;
+        double lastTime = (i > 0) ? x[i - 1] : 0;
+        double weight = (timeInYears - lastTime) / (x[i] - lastTime);
+        weights[i] = weight;
+        if (i > 0)
+        {
+            weights[i - 1] = 1 - weight;
+        }
+        return;
+    }
+
+    // tk::spline with zero curvature at both ends: A*b = D*y, where b are the coefficients of (x-xi)^2 and D takes the
+    // differences of the slopes. The value at t is alpha*y + g*b, so the weights are alpha + D^T * A^-T * g
+    int idx = std::max(int(std::lower_bound(x.begin(), x.end(), timeInYears) - x.begin()) - 1, 0);
+    std::vector<double> g(n, 0);
+    if (timeInYears < x[0])
+    {
+        // Quadratic extrapolation to the left
+        double h = timeInYears - x[0], h0 = x[1] - x[0];
+        weights[0] = 1 - h / h0;
+        weights[1] = h / h0;
+        g[0] = h * h - 2 * h * h0 / 3;
+        g[1] = -h * h0 / 3;
+    }
+    else if (timeInYears > x[n - 1])
+    {
+        // Quadratic extrapolation to the right, with the slope of the last segment at the last point
+        double h = timeInYears - x[n - 1], last = x[n - 1] - x[n - 2];
+        weights[n - 1] = 1 + h / last;
+        weights[n - 2] = -h / last;
+        g[n - 2] = h * last / 3;
+        g[n - 1] = h * h + 2 * h * last / 3;
+    }
+    else
+    {
+        double h = timeInYears - x[idx], segment = x[idx + 1] - x[idx];
+        weights[idx] = 1 - h / segment;
+        weights[idx + 1] = h / segment;
+        g[idx] = h * h - h * h * h / (3 * segment) - 2 * h * segment / 3;
+        g[idx + 1] = h * h * h / (3 * segment) - h * segment / 3;
+    }
+
+    // Transposed spline system: rows 0 and n-1 are the boundary conditions 2*b = 0
+    tk::band_matrix transposed(n, 1, 1);
+    transposed(0, 0) = 2;
+    transposed(n - 1, n - 1) = 2;
+    for (int i = 1; i < n - 1; ++i)
+    {
+        transposed(i - 1, i) = (x[i] - x[i - 1]) / 3;
+        transposed(i, i) = 2 * (x[i + 1] - x[i - 1]) / 3;
+        transposed(i + 1, i) = (x[i + 1] - x[i]) / 3;
+    }
+    std::vector<double> z = transposed.lu_solve(g);
+    for (int i = 1; i < n - 1; ++i)
+    {
+        double right = 1 / (x[i + 1] - x[i]), left = 1 / (x[i] - x[i - 1]);
+        weights[i + 1] = weights[i + 1] + right * z[i];
+        weights[i] = weights[i] - (right + left) * z[i];
+        weights[i - 1] = weights[i - 1] + left * z[i];
+    }
+}
+
+#endif //SQF_DISCOUNTFACTORCURVE_H
@@ -0,0 +1,76 @@
+#ifndef SQF_DISCOUNTFACTORINTERPOLATION_H
+#define SQF_DISCOUNTFACTORINTERPOLATION_H
+
+#include <DiscountFactorBootstrap/DiscountFactorCurve.h>
+#include <algorithm>
+#include <cmath>
+
+// Interpolation of the discount factor between two pillars (t1,P1) and (t2,P2), used as template parameters
+// (policies) by the instruments that solve a pillar together with the payment dates between the pillars:
+// - value: P(t0,t) for t1 <= t <= t2
+// - derivative: dP(t0,t)/dP2 (to solve P2 with Newton)
+
+// Linear on the discount factors
+struct LinearDiscountFactorInterpolation
+{
+    static double value(double t1, double p1, double t2, double p2, double t)
+    {
+        double weight = (t - t1) / (t2 - t1);
+        return p1 + weight * (p2 - p1);
+    }
+    static double derivative(double t1, double p1, double t2, double p2, double t)
+    {
+        return (t - t1) / (t2 - t1);
+    }
+};
+
+// Linear on the logarithm of the discount factors (flat forward rate between the pillars)
+struct LogLinearDiscountFactorInterpolation
+{
+    static double value(double t1, double p1, double t2, double p2, double t)
+    {
+        double weight = (t - t1) / (t2 - t1);
+        return p1 * pow(p2 / p1, weight);
+    }
+    static double derivative(double t1, double p1, double t2, double p2, double t)
+    {
+        double weight = (t - t1) / (t2 - t1);
+        return weight * value(t1, p1, t2, p2, t) / p2;
+    }
+};
+
+// Linear on the continuously compounded zero coupon rates R(t0,t) = -ln(P(t0,t))/t
+struct LinearZeroRateInterpolation
+{
+    static double value(double t1, double p1, double t2, double p2, double t)
+    {
+        double weight = (t - t1) / (t2 - t1);
+        double rate1 = (t1 > 0) ? -log(p1) / t1 : -log(p2) / t2;  // From t0 the rate is flat up to the first pillar
+        double rate2 = -log(p2) / t2;
+        return exp(-(rate1 + weight * (rate2 - rate1)) * t);
+    }
+    static double derivative(double t1, double p1, double t2, double p2, double t)
+    {
+        double weight = (t1 > 0) ? (t - t1) / (t2 - t1) : 1;
+        return value(t1, p1, t2, p2, t) * weight * t / (t2 * p2);
+    }
+};
+
+// Discount factor P(t0,t) between the points of a curve with the interpolation policy I (P(t0,t0) = 1 before the
+// first point, and the last segment extended after the last one)
+template <class I>
+double interpolateDiscountFactor(const DiscountFactorCurve& curve, double t)
+{
+    int n = curve.getIncrement();
+    const std::vector<double>& times = curve.getTimes();
+    int next = std::upper_bound(times.begin(), times.end(), t) - times.begin();
+    if (next >= n)
+    {
+        next = n - 1;
+    }
+    double t1 = (next > 0) ? times[next - 1] : 0;
+    double p1 = (next > 0) ? curve.getDiscountFactor(next - 1).getDiscountFactor() : 1;
+    return I::value(t1, p1, times[next], curve.getDiscountFactor(next).getDiscountFactor(), t);
+}
+
+#endif //SQF_DISCOUNTFACTORINTERPOLATION_H
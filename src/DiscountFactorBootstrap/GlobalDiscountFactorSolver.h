@@ -0,0 +1,298 @@
+#ifndef SQF_GLOBALDISCOUNTFACTORSOLVER_H
+#define SQF_GLOBALDISCOUNTFACTORSOLVER_H
+
+#include <DiscountFactorBootstrap/DiscountFactorCurve.h>
+#include <DiscountFactorBootstrap/QuoteJacobian.h>
+#include <Instrument/Instrument.h>
+#include <Spline/spline.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// Fit all the discount factors of the curve at the same time, so every instrument reprices to par even when its
+// par condition reads interpolated points that depend on later pillars (a FRA reads P(t0,t1) from the spline built
+// with all the pillars, not only the ones before it as in DiscountFactorBootstrap).
+//
+// The unknowns are the discount factor P(t0,tk) and the running annuity A(tk) at the last payment date of each
+// instrument, interleaved as x = {P0, A0, P1, A1, ...}. The equations are, for each instrument k:
+// - its par condition (see ParCondition)
+// - the annuity definition: A(tk) - A(tk-1) - b(tk-1,tk)*P(t0,tk) = 0
+// With the annuity as an unknown, a swap only involves its own pillar, so the Jacobian is a band matrix. The
+// interpolated discount factors enter with the weights of the spline, which fade away from the interpolation time:
+// the weights of the pillars farther than the bandwidth are dropped from the Jacobian (not from the residuals), so
+// the Newton steps are solved with the band LU of tk::spline.
+// A Newton step that does not reduce the residuals is retried with Levenberg-Marquardt damping on the diagonal.
+// The quote sensitivities of the solution come from the implicit function theorem, dx/dQuote = -J^-1 * dF/dQuote,
+// solved with the band LU and refined with exact products by the full Jacobian (the residuals are linear in x, so
+// J*d = F(x + d) - F(x))
+class GlobalDiscountFactorSolver
+{
+    private:
+        double tolerance;    // Maximum absolute par residual accepted
+        int maxIterations;   // Maximum number of Newton steps
+        int bandwidth;       // Pillars on each side of an interpolation time kept in the Jacobian
+        int iterations;      // Newton steps of the last solve
+        double residualNorm; // Maximum absolute residual of the last solve
+
+        DiscountFactorCurve buildCurve(const std::vector<double>& times, const std::vector<double>& x);
+        double computeResiduals(std::vector<Instrument*>& instruments, std::vector<ParCondition>& conditions,
+                                const std::vector<double>& times, const std::vector<double>& x,
+                                std::vector<double>& residuals);
+        void computeJacobian(std::vector<ParCondition>& conditions, const std::vector<double>& times,
+                             const std::vector<double>& x, tk::band_matrix& jacobian);
+        void computeQuoteJacobian(std::vector<Instrument*>& instruments, std::vector<ParCondition>& conditions,
+                                  const std::vector<double>& times, const std::vector<double>& x,
+                                  tk::band_matrix& jacobian, QuoteJacobian& quoteJacobian);
+        DiscountFactorCurve solve(std::vector<Instrument*>& instruments, std::vector<double>& x,
+                                  QuoteJacobian* quoteJacobian);
+    public:
+        GlobalDiscountFactorSolver(double _tolerance = 1e-12, int _maxIterations = 20, int _bandwidth = 8);
+
+        // Cold start: every discount factor starts at 1. If a QuoteJacobian is given, it is filled with
+        // dP(t0,tj)/dQuote_i of the solution
+        DiscountFactorCurve solve(std::vector<Instrument*> instruments, QuoteJacobian* quoteJacobian = nullptr);
+        // Warm start from a previous curve (e.g. intraday updates of the quotes)
+        DiscountFactorCurve solve(std::vector<Instrument*> instruments, const DiscountFactorCurve& initialCurve,
+                                  QuoteJacobian* quoteJacobian = nullptr);
+
+        int getNumberOfIterations(){ return this->iterations;}
+        double getResidualNorm(){ return this->residualNorm;}
+        bool hasConverged(){ return this->residualNorm <= this->tolerance;}
+};
+
+GlobalDiscountFactorSolver::GlobalDiscountFactorSolver(double _tolerance, int _maxIterations, int _bandwidth)
+{
+    this->tolerance = _tolerance;
+    this->maxIterations = _maxIterations;
+    this->bandwidth = _bandwidth;
+    this->iterations = 0;
+    this->residualNorm = 0;
+}
+
+DiscountFactorCurve GlobalDiscountFactorSolver::solve(std::vector<Instrument*> instruments, QuoteJacobian* quoteJacobian)
+{
+    std::sort(instruments.begin(), instruments.end(), compareEndPeriods);
+    std::vector<double> x(2 * instruments.size(), 1);
+    return this->solve(instruments, x, quoteJacobian);
+}
+
+DiscountFactorCurve GlobalDiscountFactorSolver::solve(std::vector<Instrument*> instruments,
+                                                      const DiscountFactorCurve& initialCurve,
+                                                      QuoteJacobian* quoteJacobian)
+{
+    std::sort(instruments.begin(), instruments.end(), compareEndPeriods);
+    std::vector<double> x(2 * instruments.size());
+    for (int k = 0; k < instruments.size(); ++k)
+    {
+        x[2 * k] = initialCurve.getInterpolatedDiscountFactor(instruments[k]->getNumberOfYearsLastPayment());
+    }
+    return this->solve(instruments, x, quoteJacobian);
+}
+
+DiscountFactorCurve GlobalDiscountFactorSolver::buildCurve(const std::vector<double>& times, const std::vector<double>& x)
+{
+    DiscountFactorCurve curve;
+    for (int k = 0; k < times.size(); ++k)
+    {
+        curve.addPoint(times[k], x[2 * k]);
+    }
+    return curve;
+}
+
+double GlobalDiscountFactorSolver::computeResiduals(std::vector<Instrument*>& instruments,
+                                                   std::vector<ParCondition>& conditions,
+                                                   const std::vector<double>& times, const std::vector<double>& x,
+                                                   std::vector<double>& residuals)
+{
+    DiscountFactorCurve curve = this->buildCurve(times, x);
+    double norm = 0;
+    for (int k = 0; k < instruments.size(); ++k)
+    {
+        const ParCondition& condition = conditions[k];
+        residuals[2 * k] = condition.constant + condition.discountFactor * x[2 * k] + condition.annuity * x[2 * k + 1];
+        if (condition.interpolated != 0)
+        {
+            residuals[2 * k] = residuals[2 * k] +
+                               condition.interpolated * curve.getInterpolatedDiscountFactor(condition.interpolationTime);
+        }
+
+        double lastTime = (k > 0) ? times[k - 1] : 0;
+        double lastAnnuity = (k > 0) ? x[2 * k - 1] : 0;
+        residuals[2 * k + 1] = x[2 * k + 1] - lastAnnuity - (times[k] - lastTime) * x[2 * k];
+
+        norm = std::max(norm, std::max(std::abs(residuals[2 * k]), std::abs(residuals[2 * k + 1])));
+    }
+    return norm;
+}
+
+void GlobalDiscountFactorSolver::computeJacobian(std::vector<ParCondition>& conditions, const std::vector<double>& times,
+                                                 const std::vector<double>& x, tk::band_matrix& jacobian)
+{
+    int n = times.size();
+    DiscountFactorCurve curve = this->buildCurve(times, x);
+    std::vector<double> bumped = x;
+    for (int k = 0; k < n; ++k)
+    {
+        const ParCondition& condition = conditions[k];
+        jacobian(2 * k, 2 * k) = condition.discountFactor;
+        jacobian(2 * k, 2 * k + 1) = condition.annuity;
+
+        // The interpolation is linear in the discount factors of the pillars: the weight of the pillar j is the change
+        // of the interpolated value when P(t0,tj) moves by 1. Only the pillars inside the band are kept
+        if (condition.interpolated != 0)
+        {
+            int closest = std::lower_bound(times.begin(), times.end(), condition.interpolationTime) - times.begin();
+            int first = std::max(std::max(closest - this->bandwidth, k - this->bandwidth), 0);
+            int last = std::min(std::min(closest + this->bandwidth, k + this->bandwidth), n - 1);
+            double value = curve.getInterpolatedDiscountFactor(condition.interpolationTime);
+            for (int j = first; j <= last; ++j)
+            {
+                bumped[2 * j] = x[2 * j] + 1;
+                double weight = this->buildCurve(times, bumped).getInterpolatedDiscountFactor(condition.interpolationTime) - value;
+                bumped[2 * j] = x[2 * j];
+                jacobian(2 * k, 2 * j) = jacobian(2 * k, 2 * j) + condition.interpolated * weight;
+            }
+        }
+
+        double lastTime = (k > 0) ? times[k - 1] : 0;
+        jacobian(2 * k + 1, 2 * k) = -(times[k] - lastTime);
+        jacobian(2 * k + 1, 2 * k + 1) = 1;
+        if (k > 0)
+        {
+            jacobian(2 * k + 1, 2 * k - 1) = -1;
+        }
+    }
+}
+
+DiscountFactorCurve GlobalDiscountFactorSolver::solve(std::vector<Instrument*>& instruments, std::vector<double>& x,
+                                                      QuoteJacobian* quoteJacobian)
+{
+    int n = instruments.size();
+    std::vector<double> times(n);
+    std::vector<ParCondition> conditions(n);
+    for (int k = 0; k < n; ++k)
+    {
+        times[k] = instruments[k]->getNumberOfYearsLastPayment();
+        conditions[k] = instruments[k]->getParCondition();
+
+        // Start with the annuities of the initial discount factors
+        double lastTime = (k > 0) ? times[k - 1] : 0;
+        double lastAnnuity = (k > 0) ? x[2 * k - 1] : 0;
+        x[2 * k + 1] = lastAnnuity + (times[k] - lastTime) * x[2 * k];
+    }
+
+    // The pillars do not move, so the spline weights (and the Jacobian) are the same in every iteration
+    tk::band_matrix jacobian(2 * n, 2 * this->bandwidth + 1, 2 * this->bandwidth + 2);
+    this->computeJacobian(conditions, times, x, jacobian);
+
+    std::vector<double> residuals(2 * n), trialResiduals(2 * n), trial(2 * n);
+    this->residualNorm = this->computeResiduals(instruments, conditions, times, x, residuals);
+    this->iterations = 0;
+    double damping = 0;
+    bool decomposed = false;
+    tk::band_matrix factorized;
+    while (this->residualNorm > this->tolerance && this->iterations < this->maxIterations)
+    {
+        this->iterations = this->iterations + 1;
+        if (!decomposed)
+        {
+            factorized = jacobian;
+            for (int i = 0; i < 2 * n; ++i)
+            {
+                factorized(i, i) = factorized(i, i) * (1 + damping);
+            }
+            factorized.lu_decompose();
+            decomposed = true;
+        }
+
+        // Newton step: J*dx = -F
+        std::vector<double> step = factorized.lu_solve(residuals, true);
+        for (int i = 0; i < 2 * n; ++i)
+        {
+            trial[i] = x[i] - step[i];
+        }
+        double trialNorm = this->computeResiduals(instruments, conditions, times, trial, trialResiduals);
+        if (trialNorm < this->residualNorm)
+        {
+            x.swap(trial);
+            residuals.swap(trialResiduals);
+            this->residualNorm = trialNorm;
+            if (damping > 0)
+            {
+                damping = (damping > 1e-6) ? damping / 10 : 0;
+                decomposed = false;
+            }
+        }
+        else
+        {
+            damping = (damping > 0) ? damping * 10 : 1e-3;
+            decomposed = false;
+        }
+    }
+
+    if (quoteJacobian != nullptr)
+    {
+        this->computeQuoteJacobian(instruments, conditions, times, x, jacobian, *quoteJacobian);
+    }
+
+    DiscountFactorCurve curve = this->buildCurve(times, x);
+    curve.interpolate();
+    return curve;
+}
+
+void GlobalDiscountFactorSolver::computeQuoteJacobian(std::vector<Instrument*>& instruments,
+                                                      std::vector<ParCondition>& conditions,
+                                                      const std::vector<double>& times, const std::vector<double>& x,
+                                                      tk::band_matrix& jacobian, QuoteJacobian& quoteJacobian)
+{
+    int n = instruments.size();
+    quoteJacobian.reset(n);
+    for (int j = 0; j < n; ++j)
+    {
+        quoteJacobian.setPillar(j, times[j], x[2 * j]);
+    }
+
+    tk::band_matrix factorized = jacobian;
+    factorized.lu_decompose();
+    std::vector<double> residuals(2 * n), shiftedResiduals(2 * n), shifted(2 * n), rightHandSide(2 * n);
+    this->computeResiduals(instruments, conditions, times, x, residuals);
+    for (int i = 0; i < n; ++i)
+    {
+        // Only the par condition of the instrument i depends on its quote
+        ParCondition derivative = instruments[i]->getParConditionQuoteDerivative();
+        std::fill(rightHandSide.begin(), rightHandSide.end(), 0);
+        rightHandSide[2 * i] = -(derivative.constant + derivative.discountFactor * x[2 * i] + derivative.annuity * x[2 * i + 1]);
+
+        std::vector<double> sensitivity = factorized.lu_solve(rightHandSide, true);
+        for (int refinement = 0; refinement < this->maxIterations; ++refinement)
+        {
+            for (int m = 0; m < 2 * n; ++m)
+            {
+                shifted[m] = x[m] + sensitivity[m];
+            }
+            this->computeResiduals(instruments, conditions, times, shifted, shiftedResiduals);
+            double error = 0;
+            for (int m = 0; m < 2 * n; ++m)
+            {
+                shiftedResiduals[m] = rightHandSide[m] - (shiftedResiduals[m] - residuals[m]);
+                error = std::max(error, std::abs(shiftedResiduals[m]));
+            }
+            if (error <= this->tolerance)
+            {
+                break;
+            }
+            std::vector<double> correction = factorized.lu_solve(shiftedResiduals, true);
+            for (int m = 0; m < 2 * n; ++m)
+            {
+                sensitivity[m] = sensitivity[m] + correction[m];
+            }
+        }
+
+        for (int j = 0; j < n; ++j)
+        {
+            quoteJacobian(j, i) = sensitivity[2 * j];
+        }
+    }
+}
+
+#endif //SQF_GLOBALDISCOUNTFACTORSOLVER_H
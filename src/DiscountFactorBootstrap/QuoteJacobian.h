@@ -0,0 +1,84 @@
+#ifndef SQF_QUOTEJACOBIAN_H
+#define SQF_QUOTEJACOBIAN_H
+
+#include <vector>
+
+// Sensitivities of the pillars of a curve to the market quotes it was built from, dP(t0,tj)/dQuote_i, produced by
+// DiscountFactorBootstrap or GlobalDiscountFactorSolver while building the curve. The quotes are numbered as the
+// pillars (instrument i is the one with the i-th last payment date), so the matrix is square.
+// Risk computed against the pillars (discount factors or continuously compounded zero rates) is mapped to risk
+// against the quotes with one matrix product instead of bootstrapping again once per quote
+class QuoteJacobian
+{
+    private:
+        int numPillars;
+        std::vector<double> times;           // b(t0,tj) of the pillars
+        std::vector<double> discountFactors; // P(t0,tj) of the pillars
+        std::vector<double> sensitivities;   // dP(t0,tj)/dQuote_i at j*numPillars + i
+    public:
+        QuoteJacobian();
+
+        void reset(int _numPillars);
+        void setPillar(int j, double time, double discountFactor);
+        double& operator () (int pillar, int quote){ return this->sensitivities[pillar * this->numPillars + quote];}
+
+        int getNumberOfPillars(){ return this->numPillars;}
+        double getDiscountFactorSensitivity(int pillar, int quote){ return (*this)(pillar, quote);}
+        double getZeroRateSensitivity(int pillar, int quote);  // dR(t0,tj)/dQuote_i with R = -ln(P)/b
+
+        // dV/dQuote_i from dV/dP(t0,tj) or dV/dR(t0,tj)
+        std::vector<double> mapDiscountFactorRisk(const std::vector<double>& discountFactorRisk);
+        std::vector<double> mapZeroRateRisk(const std::vector<double>& zeroRateRisk);
+};
+
+QuoteJacobian::QuoteJacobian()
+{
+    this->numPillars = 0;
+}
+
+void QuoteJacobian::reset(int _numPillars)
+{
+    this->numPillars = _numPillars;
+    this->times.assign(_numPillars, 0);
+    this->discountFactors.assign(_numPillars, 0);
+    this->sensitivities.assign(_numPillars * _numPillars, 0);
+}
+
+void QuoteJacobian::setPillar(int j, double time, double discountFactor)
+{
+    this->times[j] = time;
+    this->discountFactors[j] = discountFactor;
+}
+
+double QuoteJacobian::getZeroRateSensitivity(int pillar, int quote)
+{
+    // dR/dP = -1/(b*P)
+    return -(*this)(pillar, quote) / (this->times[pillar] * this->discountFactors[pillar]);
+}
+
+std::vector<double> QuoteJacobian::mapDiscountFactorRisk(const std::vector<double>& discountFactorRisk)
+{
+    std::vector<double> quoteRisk(this->numPillars, 0);
+    for (int j = 0; j < this->numPillars; ++j)
+    {
+        const double* row = &this->sensitivities[j * this->numPillars];
+        for (int i = 0; i < this->numPillars; ++i)
+        {
+            quoteRisk[i] = quoteRisk[i] + discountFactorRisk[j] * row[i];
+        }
+    }
+    return quoteRisk;
+}
+
+std::vector<double> QuoteJacobian::mapZeroRateRisk(const std::vector<double>& zeroRateRisk)
+{
+    // Chain rule through the discount factors: dV/dP = dV/dR * dR/dP
+    std::vector<double> discountFactorRisk(this->numPillars);
+    for (int j = 0; j < this->numPillars; ++j)
+    {
+        discountFactorRisk[j] = -zeroRateRisk[j] / (this->times[j] * this->discountFactors[j]);
+    }
+    return this->mapDiscountFactorRisk(discountFactorRisk);
+}
+
+#endif //SQF_QUOTEJACOBIAN_H
@@ -4,72 +4,149 @@
 #include <Date/Actual_360.h>
 #include <Date/Thirty_360.h>
 #include <Instrument/Instrument.h>
+#include <memory>
 #include <vector>
 #include <Instrument/Payment/Payment.h>
+#include <ZeroCouponYieldCurve/ZeroCouponYieldCurve.h>
 
 template <class T>
 class Bond : public Instrument
 {
 	private:
+        typedef Payment<typename CurveCompounding<T>::type> LegPayment;  // Discounted with the curve compounding
+
         // Variables which define the bond
         double initialCapital;            // Nominal
         std::tm presentValueDate;         // Date of the present value day
         std::tm lastPaymentDate;          // Date of the last payment
-        T zeroCoupon;                     // Zero coupon object (allows one to extract forward)
-        std::vector<Payment> FixPayment;  // Vector of type Payment (it has its properties implemented)
+        std::shared_ptr<const T> zeroCoupon;  // Zero coupon curve (shared: it lives as long as the bond)
+        std::vector<LegPayment> FixPayment;  // Vector of type Payment (it has its properties implemented)
+
+        // The payments of a payment calendar are generated on first use. Then only their zero coupon rates are read
+        // again when the curve changes
+        std::vector<std::tm> paymentCalendar;  // Payment dates (empty if the payments are given)
+        double fixInterestRate;
+        unsigned long paymentsVersion;         // Version of the curve the payments were read from
+        int numPaymentGenerations;
+        int numPaymentRefreshes;
+
+        void generatePayments();          // Day counts and payments (curve invariant) and their rates
+        void refreshPayments();           // Zero coupon rates only: no day counts nor allocations
+        void materializePayments();
 
 	public:
+        // The bond keeps a copy of the curve: later changes of _zeroCoupon are not seen by the bond
         Bond(double _initialCapital, T& _zeroCoupon, std::tm lastPayment);  // Default constructor
         Bond(double _initialCapital, T& _zeroCoupon, std::vector<std::tm> _paymentCalendar, double fixInterestRate);
+        // The bond shares the curve: the payments follow its changes
+        Bond(double _initialCapital, std::shared_ptr<const T> _zeroCoupon, std::tm lastPayment);
+        Bond(double _initialCapital, std::shared_ptr<const T> _zeroCoupon, std::vector<std::tm> _paymentCalendar, double fixInterestRate);
 		~Bond();
 
         double computePresentValue();
         void fixPaymentValuations(double interest, double numOfPaymentsPerYear);
 
         // Getter of the vector of payments
-        std::vector<Payment> getPaymentVector(){return this->FixPayment;}
+        std::vector<LegPayment> getPaymentVector(){ this->materializePayments(); return this->FixPayment;}
+        int getNumberOfPaymentGenerations(){ return this->numPaymentGenerations;}
+        int getNumberOfPaymentRefreshes(){ return this->numPaymentRefreshes;}
 };
 
 template <class T>
 Bond<T>::Bond(double _initialCapital, T& _zeroCoupon, std::tm lastPayment)
+    : Bond(_initialCapital, std::make_shared<const T>(_zeroCoupon), lastPayment)
+{
+}
+
+template <class T>
+Bond<T>::Bond(double _initialCapital, T& _zeroCoupon, std::vector<std::tm> _paymentCalendar, double fixInterestRate)
+    : Bond(_initialCapital, std::make_shared<const T>(_zeroCoupon), _paymentCalendar, fixInterestRate)
+{
+}
+
+template <class T>
+Bond<T>::Bond(double _initialCapital, std::shared_ptr<const T> _zeroCoupon, std::tm lastPayment)
 {
     this->initialCapital = _initialCapital;
     this->zeroCoupon = _zeroCoupon;
-    this->presentValueDate = _zeroCoupon.getPresentValue();
+    this->presentValueDate = _zeroCoupon->getPresentValue();
     this->lastPaymentDate = lastPayment;
+    this->numPaymentGenerations = 0;
+    this->numPaymentRefreshes = 0;
 }
 
 
 template <class T>
-Bond<T>::Bond(double _initialCapital, T& _zeroCoupon, std::vector<std::tm> _paymentCalendar, double fixInterestRate)
+Bond<T>::Bond(double _initialCapital, std::shared_ptr<const T> _zeroCoupon, std::vector<std::tm> _paymentCalendar, double fixInterestRate)
 {
-    // Compute payments from a date vector which contains the payment dates
+    // Keep the payment dates: the payments are computed when the bond is valued (materializePayments)
     this->initialCapital= _initialCapital;
     this->zeroCoupon = _zeroCoupon;
-    this->presentValueDate = _zeroCoupon.getPresentValue();
+    this->presentValueDate = _zeroCoupon->getPresentValue();
     this->lastPaymentDate = _paymentCalendar.back();  // Returns a reference to last payment in the vector
+    this->paymentCalendar = _paymentCalendar;
+    this->fixInterestRate = fixInterestRate;
+    this->numPaymentGenerations = 0;
+    this->numPaymentRefreshes = 0;
+}
+
+template <class T>
+void Bond<T>::materializePayments()
+{
+    if (this->paymentCalendar.empty())
+    {
+        return;  // Payments given with fixPaymentValuations
+    }
+    if (this->numPaymentGenerations == 0)
+    {
+        this->generatePayments();
+    }
+    else if (this->paymentsVersion != this->zeroCoupon->getVersion())
+    {
+        this->refreshPayments();
+    }
+}
 
+template <class T>
+void Bond<T>::generatePayments()
+{
     // Initialize date variables: Delta(t) = dateInYears - lastDateInYears
     double dateInYears = 0;
     double lastDateInYears = 0;
+    this->FixPayment.clear();
 
     // Add payment object to FixPayment vector (this object has the methods of the Payment class)
-    for(int i = 0; i<_paymentCalendar.size(); ++i)
+    for(int i = 0; i<this->paymentCalendar.size(); ++i)
     {
         // Update dates when the payments occur
-        // getTimeInDayCountConvention: Diff in years from paymentCalendar[i] to initialDate (class attribute of zeroCouponYieldCurve)
+        // getTimeInYearsFromPresentDate: Diff in years from paymentCalendar[i] to initialDate (class attribute of zeroCouponYieldCurve)
         // getInterpolatedZCRate: interest rate from yield curve for the period in years by interpolating methods
         lastDateInYears = dateInYears;
-        dateInYears = zeroCoupon.getTimeInDayCountConvention(_paymentCalendar[i]);
-        FixPayment.push_back(Payment(this->initialCapital, this->zeroCoupon.getInterpolatedZCRate(dateInYears),
-                fixInterestRate, dateInYears, dateInYears - lastDateInYears));
+        dateInYears = this->zeroCoupon->getTimeInYearsFromPresentDate(this->paymentCalendar[i]);
+        FixPayment.push_back(LegPayment(this->initialCapital, this->zeroCoupon->getInterpolatedZCRate(dateInYears),
+                this->fixInterestRate, dateInYears, dateInYears - lastDateInYears));
+    }
+    this->paymentsVersion = this->zeroCoupon->getVersion();
+    this->numPaymentGenerations = this->numPaymentGenerations + 1;
+}
+
+template <class T>
+void Bond<T>::refreshPayments()
+{
+    // Only the zero coupon rates depend on the curve
+    for(int i = 0; i<this->FixPayment.size(); ++i)
+    {
+        this->FixPayment[i].setInterestRate(this->zeroCoupon->getInterpolatedZCRate(this->FixPayment[i].getNumOfYearsFromPresentValue()));
     }
+    this->paymentsVersion = this->zeroCoupon->getVersion();
+    this->numPaymentRefreshes = this->numPaymentRefreshes + 1;
 }
 
 template <class T>
 double Bond<T>::computePresentValue()
 {
     // Update the value of the bond (sum of all payments). Each payment is calculated through eq 2.7 of notes
+    this->materializePayments();
     double ret = 0;
     for(int i=0;i<FixPayment.size();i++)
     {
@@ -83,7 +160,7 @@ template <class T>
 void Bond<T>::fixPaymentValuations(double interest, double numOfPaymentsPerYear)
 {
     std::tm date;
-    int lastPayment = (int)round(zeroCoupon.getTimeInDayCountConvention(this->lastPaymentDate));  // Num years from initialDate
+    int lastPayment = (int)round(zeroCoupon->getTimeInDayCountConvention(this->lastPaymentDate));  // Num years from initialDate
     double fracNumPaymentsPerYear = 1/(numOfPaymentsPerYear);
 
     cout<<"The payment calendar for the Fix Payments will be: "<<endl;
@@ -91,9 +168,9 @@ void Bond<T>::fixPaymentValuations(double interest, double numOfPaymentsPerYear)
     {
         // DayCountCalculator::generate_tm:
         // adds i to presentValueDate (i is the time in years we want to add, next payment period)
-        date = zeroCoupon.getDayCountConvention().generate_tm(this->presentValueDate, i);
+        date = zeroCoupon->getDayCountConvention().generate_tm(this->presentValueDate, i);
         cout<<"dd/mm/yyyy: "<<date.tm_mday<<"/"<<date.tm_mon+1<<"/"<<date.tm_year+1900<<endl;
-        FixPayment.push_back(Payment(this->initialCapital, this->zeroCoupon.getInterpolatedZCRate(i), interest,
+        FixPayment.push_back(LegPayment(this->initialCapital, this->zeroCoupon->getInterpolatedZCRate(i), interest,
                 i, fracNumPaymentsPerYear )); // Payment definition between a period and the following one
     }
     cout<<"\n"<<endl;
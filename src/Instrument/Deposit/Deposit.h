@@ -3,6 +3,7 @@
 
 #include <ctime>
 #include <Instrument/Instrument.h>
+#include <Compounding/Compounding.h>
 
 template <class T>
 class Deposit : public Instrument
@@ -13,6 +14,8 @@ class Deposit : public Instrument
         Deposit(T dayCount, double interest, std::tm startDate, std::tm endDate);
         Deposit(double interest, double numOfMonth);
         DiscountFactor getDiscountFactor();  // Returns the discount factor object
+        ParCondition getParCondition();      // P(t0,ti)*(1 + R(t0,ti)*b(t0,ti)) - 1
+        ParCondition getParConditionQuoteDerivative();
 };
 
 // Constructor from two dates
@@ -49,10 +52,23 @@ template <class T>
 DiscountFactor Deposit<T>::getDiscountFactor()
 {
     // Compute discount factor of a deposit (EQUATION 3.1)
-    double discountFactor = 1 / (1 + this->interestRate * this->getNumberOfYearsLastPayment());
+    double discountFactor = SimpleCompounding::discountFactor(this->interestRate, this->getNumberOfYearsLastPayment());
     return DiscountFactor(this->getNumberOfYearsLastPayment(), discountFactor); // Returns a discount factor object
     // this->getNumberOfYearsLastPayment(): returns the number of years from last payment specified and setted
     // in the constructor of a Deposit object
 }
 
+template <class T>
+ParCondition Deposit<T>::getParCondition()
+{
+    double growthFactor = SimpleCompounding::growthFactor(this->interestRate, this->getNumberOfYearsLastPayment());
+    return ParCondition{-1, growthFactor, 0, 0, 0};
+}
+
+template <class T>
+ParCondition Deposit<T>::getParConditionQuoteDerivative()
+{
+    return ParCondition{0, this->getNumberOfYearsLastPayment(), 0, 0, 0};
+}
+
 #endif //SQF_DEPOSIT_H
@@ -17,9 +17,22 @@ class FRA : public Instrument
     public:
         FRA(T dayCount, double interest, std::tm presentValue, std::tm startDate, std::tm endDate);
         FRA(double interest, double startDateInYears, double endDateInYears);
-        DiscountFactor getDiscountFactor();
+        DiscountFactor getDiscountFactor(const DiscountFactorCurve& curve);
+        DiscountFactor getDiscountFactor();  // From the previous discount factors (see setPreviousDiscountFactors)
+        void setPreviousDiscountFactors(vector<DiscountFactor> &prevDiscountFactors);
+        ParCondition getParCondition();  // P(t0,t2)*(1 + f(t0,t1,t2)*b(t1,t2)) - P(t0,t1)
+        ParCondition getParConditionQuoteDerivative();
 };
 
+// EQUATION 3.10: P(t0,t2) = P(t0,t1) / (1 + f(t0,t1,t2)*b(t1,t2)), with P(t0,t1) interpolated in the curve built with
+// the instruments that end before the FRA (P(t0,t0) = 1 if the FRA starts today). Shared by FRA and InstrumentArena
+double computeFRADiscountFactor(double fraInterestRate, double startDateInYears, double dayCountFactor,
+                                const DiscountFactorCurve& curve)
+{
+    double discountFactorStartPeriod = (startDateInYears > 0) ? curve.getInterpolatedDiscountFactor(startDateInYears) : 1;
+    return discountFactorStartPeriod / (1 + fraInterestRate * dayCountFactor);
+}
+
 // Constructor given the dates between the FRA is happening and the present date on which we want to valuate the FRA
 template <class T>
 FRA<T>::FRA(T dayCount, double interest, std::tm presentValue, std::tm startDate, std::tm endDate)
@@ -54,14 +67,47 @@ FRA<T>::FRA(double interest, double startDateInMonth, double endDateInMonth)
 }
 
 template <class T>
-DiscountFactor FRA<T>::getDiscountFactor()
+DiscountFactor FRA<T>::getDiscountFactor(const DiscountFactorCurve& curve)
 {
-    // Use getInterpolatedDiscountFactor method from DiscountFactorBootstrap to obtain the discount factor from t0 to t1
-    double discountFactorStartPeriod = DiscountFactorBootstrap::getInterpolatedDiscountFactor(this->startDateInYears);
-
     // EQUATION 3.10: Discount factor between t0 and t2
-    double discountFactor = discountFactorStartPeriod / (1 + this->fraInterestRate * this->dayCountFactor);
+    double discountFactor = computeFRADiscountFactor(this->fraInterestRate, this->startDateInYears, this->dayCountFactor, curve);
     return DiscountFactor(this->getNumberOfYearsLastPayment(), discountFactor);  // Returns a discount factor object
 }
 
+template <class T>
+void FRA<T>::setPreviousDiscountFactors(vector<DiscountFactor> &prevDiscountFactors)
+{
+    this->previousDiscountFactors = prevDiscountFactors;
+}
+
+template <class T>
+DiscountFactor FRA<T>::getDiscountFactor()
+{
+    // P(t0,t1) is interpolated in the curve of the previous discount factors
+    DiscountFactorCurve curve;
+    for (int i = 0; i < this->previousDiscountFactors.size(); ++i)
+    {
+        curve.addPoint(this->previousDiscountFactors[i].getYearsFromPresentValue(), this->previousDiscountFactors[i].getDiscountFactor());
+    }
+    return this->getDiscountFactor(curve);
+}
+
+template <class T>
+ParCondition FRA<T>::getParCondition()
+{
+    // EQUATION 3.10. P(t0,t1) is interpolated in the curve, unless the FRA starts today (P(t0,t0) = 1)
+    double growthFactor = 1 + this->fraInterestRate * this->dayCountFactor;
+    if (this->startDateInYears == 0)
+    {
+        return ParCondition{-1, growthFactor, 0, 0, 0};
+    }
+    return ParCondition{0, growthFactor, 0, -1, this->startDateInYears};
+}
+
+template <class T>
+ParCondition FRA<T>::getParConditionQuoteDerivative()
+{
+    return ParCondition{0, this->dayCountFactor, 0, 0, 0};
+}
+
 #endif //SQF_FRA_H
@@ -2,10 +2,24 @@
 #define SQF_INSTRUMENT_H
 
 #include <DiscountFactor/DiscountFactor.h>  // To calculate the interest rate which is not given
+#include <DiscountFactorBootstrap/DiscountFactorCurve.h>
 #include <vector>
 
 using namespace std;
 
+// Par condition of an instrument, linear in the discount factors of the curve. It is zero when the instrument
+// reprices to par:
+// constant + discountFactor*P(t0,tn) + annuity*A(tn) + interpolated*P(t0,interpolationTime)
+// where tn is the last payment date and A(tn) the running annuity of the curve up to tn (EQUATION 3.6)
+struct ParCondition
+{
+    double constant;
+    double discountFactor;
+    double annuity;
+    double interpolated;
+    double interpolationTime;
+};
+
 // Struct (everything is public) from which the specific instruments inherit:
 // Although each instrument has different equations to asses them in the present value, all of this equations depend on:
 // The interest rate R(t0,ti), the number of days expressed in years b(t0,ti),and the discount factor P(t0,ti)
@@ -16,10 +30,21 @@ struct Instrument
     vector<DiscountFactor> previousDiscountFactors;  // Vector of previous DF {df0, df1,...df{t-1}}: P(t0,t{i-1})
     double const getNumberOfYearsLastPayment();
     void setNumberOfYearsLastPayment(double lastPaymentYears);  // Keep track of the valuation dates of all the instruments used to build the discount factor curve
+    virtual ~Instrument(){}  // The instruments are deleted through Instrument pointers
 
     // Getter y setter to complete in each of the classes
-    virtual DiscountFactor getDiscountFactor(){};
+    // Instruments that are not used to build the curve (Bond) return an empty discount factor
+    virtual DiscountFactor getDiscountFactor(){ return DiscountFactor();};
+    // Discount factor given the curve built with the instruments that end before (only needed by some instruments)
+    virtual DiscountFactor getDiscountFactor(const DiscountFactorCurve& curve){ return this->getDiscountFactor();};
     virtual void setPreviousDiscountFactors(vector<DiscountFactor> &prevDiscountFactors) {};
+
+    // Par condition used to fit all the curve at the same time (GlobalDiscountFactorSolver)
+    virtual ParCondition getParCondition(){ return ParCondition{0, 0, 0, 0, 0};};
+    // Derivative of the coefficients of the par condition with respect to the market quote of the instrument
+    virtual ParCondition getParConditionQuoteDerivative(){ return ParCondition{0, 0, 0, 0, 0};};
+    // Par residual in a curve where the point i is the last payment date of the instrument
+    double getParResidual(const DiscountFactorCurve& curve, int i);
 };
 
 bool compareEndPeriods(Instrument* a, Instrument* b)
@@ -39,4 +64,16 @@ void Instrument::setNumberOfYearsLastPayment(double lastPaymentYears)
     this->numberOfYearsFromPresentValueToLastPayment = lastPaymentYears;
 }
 
+double Instrument::getParResidual(const DiscountFactorCurve& curve, int i)
+{
+    ParCondition condition = this->getParCondition();
+    double residual = condition.constant + condition.discountFactor * curve.getDiscountFactor(i).getDiscountFactor() +
+                      condition.annuity * curve.getAnnuity(i);
+    if (condition.interpolated != 0)
+    {
+        residual = residual + condition.interpolated * curve.getInterpolatedDiscountFactor(condition.interpolationTime);
+    }
+    return residual;
+}
+
 #endif //SQF_INSTRUMENT_H
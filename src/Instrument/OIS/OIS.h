@@ -0,0 +1,265 @@
+#ifndef SQF_OIS_H
+#define SQF_OIS_H
+
+#include <Instrument/Instrument.h>
+#include <DiscountFactorBootstrap/DiscountFactorCurve.h>
+#include <DiscountFactorBootstrap/DiscountFactorInterpolation.h>
+#include <MarketQuotes/FixingSeries.h>
+#include <Date/Actual_360.h>
+#include <cmath>
+#include <ctime>
+#include <stdexcept>
+#include <vector>
+
+// Overnight index swap: a fix leg S(t0,tn) against the overnight fixings compounded daily over each coupon.
+// The compounded coupons are never built fixing by fixing:
+// - Projected coupons telescope, 1 + R(ti-1,ti)*b(ti-1,ti) = P(t0,ti-1)/P(t0,ti), so the whole float leg of
+//   consecutive coupons is P(t0,t{start}) - P(t0,tn)
+// - The part of a coupon that started before the present is compounded with the prefix products of a FixingSeries,
+//   G(t{start},t0), so the float leg is G(t{start},t0) - P(t0,tn)
+// and the par condition is S(t0,tn) * sum of b(t{i-1},ti)*P(t0,ti) + P(t0,tn) = G(t{start},t0) (or P(t0,t{start})).
+// The days are counted from the present value (the past ones are negative) and the times are actual/360.
+// As in ScheduledSwap, the payment dates after the last pillar of the curve are interpolated with the policy I and
+// the new pillar is solved with Newton. For the same reason the par condition is not linear in the pillars: the OIS
+// has no ParCondition, so it cannot be used with the GlobalDiscountFactorSolver nor in a QuoteJacobian
+template <class T, class I = LogLinearDiscountFactorInterpolation>
+class OIS : public Instrument
+{
+    private:
+        double fixInterestRate;             // S(t0,tn)
+        int startDay;                       // Start of the first coupon not paid yet
+        std::vector<int> endDays;           // End (and payment) of the coupons not paid yet
+        std::vector<double> paymentTimes;   // b(t0,ti)
+        std::vector<double> accruals;       // b(t{i-1},ti) of the fix leg
+        FixingSeries* fixings;              // Fixings of the coupon that started before the present (nullptr if none)
+        double tolerance;                   // Newton tolerance on the par condition
+        int maxIterations;
+
+        void setSchedule(std::vector<int> periodDays, std::vector<double> periodAccruals);
+        // G(t{start},t0) when the first coupon started before the present. Throws std::invalid_argument if the fixings
+        // do not go back to the start
+        double getStartGrowthFactor();
+    public:
+        // Spot starting OIS of numOfMonth months: a single coupon up to one year, and yearly coupons after that
+        OIS(double fixIntRate, double numOfMonth);
+        // OIS with the coupon dates {start, end1, ..., endn}. If the start is before the present, the fixings from the
+        // start are needed (the coupons already paid are dropped). Throws std::invalid_argument if every coupon is paid
+        // or if the first coupon started before the present and there are no fixings
+        OIS(T dayCount, double fixIntRate, std::tm presentValue, std::vector<std::tm> periodDates,
+            FixingSeries* _fixings = nullptr);
+
+        DiscountFactor getDiscountFactor(const DiscountFactorCurve& curve);
+        DiscountFactor getDiscountFactor();  // From the previous discount factors (see setPreviousDiscountFactors)
+        void setPreviousDiscountFactors(vector<DiscountFactor> &prevDiscountFactors);
+
+        // Pricing on a built curve (read with interpolateDiscountFactor<I>), per unit of nominal receiving the fix leg
+        double computePresentValue(const DiscountFactorCurve& curve);
+        double computeParRate(const DiscountFactorCurve& curve);
+        // Daily compounded rate of the coupon i (fixings for the past days, curve for the projected ones). O(1)
+        double getCompoundedRate(int i, const DiscountFactorCurve& curve);
+
+        int getNumberOfCoupons(){ return this->endDays.size();}
+        double getPaymentTime(int i){ return this->paymentTimes[i];}
+};
+
+// Constructor given the number of months between the present date and the last payment date
+template <class T, class I>
+OIS<T, I>::OIS(double fixIntRate, double numOfMonth)
+{
+    this->fixInterestRate = fixIntRate;
+    this->fixings = nullptr;
+
+    // Months of 30 days, so the times in years are numOfMonth / 12 as in the other instruments
+    std::vector<int> periodDays;
+    std::vector<double> periodAccruals;
+    periodDays.push_back(0);
+    int lastDay = (int)round(numOfMonth * 30);
+    for (int day = 360; day < lastDay; day = day + 360)
+    {
+        periodDays.push_back(day);
+    }
+    periodDays.push_back(lastDay);
+    for (int i = 1; i < periodDays.size(); ++i)
+    {
+        periodAccruals.push_back((periodDays[i] - periodDays[i - 1]) / 360.0);
+    }
+    this->setSchedule(periodDays, periodAccruals);
+}
+
+// Constructor given the dates of the coupons
+template <class T, class I>
+OIS<T, I>::OIS(T dayCount, double fixIntRate, std::tm presentValue, std::vector<std::tm> periodDates,
+               FixingSeries* _fixings)
+{
+    this->fixInterestRate = fixIntRate;
+    this->fixings = _fixings;
+
+    // The overnight fixings accrue on actual days, and the fix leg with the day count of the swap
+    std::vector<int> periodDays;
+    std::vector<double> periodAccruals;
+    for (int i = 0; i < periodDates.size(); ++i)
+    {
+        periodDays.push_back((int)round(Actual_360::compute_daycount(presentValue, periodDates[i])));
+        if (i > 0)
+        {
+            periodAccruals.push_back(dayCount.compute_daycount(periodDates[i - 1], periodDates[i]) / 360);
+        }
+    }
+    this->setSchedule(periodDays, periodAccruals);
+
+    // The overnight interest already accrued by the first coupon would be dropped
+    if (this->startDay < 0 && this->fixings == nullptr)
+    {
+        throw std::invalid_argument("OIS: the first coupon started before the present and there are no fixings");
+    }
+}
+
+template <class T, class I>
+void OIS<T, I>::setSchedule(std::vector<int> periodDays, std::vector<double> periodAccruals)
+{
+    // Drop the coupons already paid: the first one left may have started before the present
+    this->startDay = periodDays[0];
+    for (int i = 1; i < periodDays.size(); ++i)
+    {
+        if (periodDays[i] <= 0)
+        {
+            this->startDay = periodDays[i];
+            continue;
+        }
+        this->endDays.push_back(periodDays[i]);
+        this->paymentTimes.push_back(periodDays[i] / 360.0);
+        this->accruals.push_back(periodAccruals[i - 1]);
+    }
+    if (this->paymentTimes.empty())
+    {
+        throw std::invalid_argument("OIS: every coupon is already paid");
+    }
+
+    // The last payment date is the pillar of the OIS. It will be useful to order instruments by their finalization date
+    this->setNumberOfYearsLastPayment(this->paymentTimes.back());
+    this->tolerance = 1e-15;
+    this->maxIterations = 50;
+}
+
+template <class T, class I>
+double OIS<T, I>::getStartGrowthFactor()
+{
+    // The constructor checked there are fixings
+    double growthFactor = this->fixings->getGrowthFactor(this->startDay, 0);
+    if (growthFactor < 0)
+    {
+        throw std::invalid_argument("OIS: no fixing at the start of the first coupon");
+    }
+    return growthFactor;
+}
+
+template <class T, class I>
+DiscountFactor OIS<T, I>::getDiscountFactor(const DiscountFactorCurve& curve)
+{
+    // Payments up to the last pillar of the curve are known
+    double lastTime = curve.getLastTime();
+    double lastDiscountFactor = (curve.getIncrement() > 0) ? curve.getDiscountFactor(curve.getIncrement() - 1).getDiscountFactor() : 1;
+    double knownLeg = 0;
+    int firstUnknown = 0;
+    while (firstUnknown < this->paymentTimes.size() && this->paymentTimes[firstUnknown] <= lastTime)
+    {
+        knownLeg = knownLeg + this->accruals[firstUnknown] * interpolateDiscountFactor<I>(curve, this->paymentTimes[firstUnknown]);
+        firstUnknown = firstUnknown + 1;
+    }
+
+    // Float leg value at the start: compounded fixings, or P(t0,t{start}) (unknown if after the last pillar)
+    double startTime = this->startDay / 360.0;
+    bool startKnown = (startTime <= lastTime);
+    double startValue = 1;
+    if (this->startDay < 0)
+    {
+        startValue = this->getStartGrowthFactor();
+    }
+    else if (this->startDay > 0 && startKnown)
+    {
+        startValue = interpolateDiscountFactor<I>(curve, startTime);
+    }
+
+    // Newton on P(t0,tn): f(P) = S*(knownLeg + sum of b*P(t0,ti)) + P - startValue. The first guess is the discount
+    // factor with the same forward rate as the last pillar
+    double pillar = this->getNumberOfYearsLastPayment();
+    double discountFactor = (lastTime > 0) ? pow(lastDiscountFactor, pillar / lastTime) : 1 / (1 + this->fixInterestRate * pillar);
+    for (int iteration = 0; iteration < this->maxIterations; ++iteration)
+    {
+        double leg = knownLeg;
+        double legDerivative = 0;
+        for (int i = firstUnknown; i < this->paymentTimes.size(); ++i)
+        {
+            leg = leg + this->accruals[i] * I::value(lastTime, lastDiscountFactor, pillar, discountFactor, this->paymentTimes[i]);
+            legDerivative = legDerivative + this->accruals[i] * I::derivative(lastTime, lastDiscountFactor, pillar, discountFactor, this->paymentTimes[i]);
+        }
+        double start = startValue;
+        double startDerivative = 0;
+        if (!startKnown)
+        {
+            start = I::value(lastTime, lastDiscountFactor, pillar, discountFactor, startTime);
+            startDerivative = I::derivative(lastTime, lastDiscountFactor, pillar, discountFactor, startTime);
+        }
+        double residual = this->fixInterestRate * leg + discountFactor - start;
+        if (std::abs(residual) <= this->tolerance)
+        {
+            break;
+        }
+        discountFactor = discountFactor - residual / (this->fixInterestRate * legDerivative + 1 - startDerivative);
+    }
+    return DiscountFactor(pillar, discountFactor);
+}
+
+template <class T, class I>
+double OIS<T, I>::computePresentValue(const DiscountFactorCurve& curve)
+{
+    double fixLeg = 0;
+    for (int i = 0; i < this->paymentTimes.size(); ++i)
+    {
+        fixLeg = fixLeg + this->accruals[i] * interpolateDiscountFactor<I>(curve, this->paymentTimes[i]);
+    }
+    double start = (this->startDay < 0) ? this->getStartGrowthFactor() : interpolateDiscountFactor<I>(curve, this->startDay / 360.0);
+    double floatLeg = start - interpolateDiscountFactor<I>(curve, this->paymentTimes.back());
+    return this->fixInterestRate * fixLeg - floatLeg;
+}
+
+template <class T, class I>
+double OIS<T, I>::computeParRate(const DiscountFactorCurve& curve)
+{
+    double annuity = 0;
+    for (int i = 0; i < this->paymentTimes.size(); ++i)
+    {
+        annuity = annuity + this->accruals[i] * interpolateDiscountFactor<I>(curve, this->paymentTimes[i]);
+    }
+    double start = (this->startDay < 0) ? this->getStartGrowthFactor() : interpolateDiscountFactor<I>(curve, this->startDay / 360.0);
+    return (start - interpolateDiscountFactor<I>(curve, this->paymentTimes.back())) / annuity;
+}
+
+template <class T, class I>
+double OIS<T, I>::getCompoundedRate(int i, const DiscountFactorCurve& curve)
+{
+    // Growth over the coupon: G(t{start},t0)/P(t0,ti) if it started in the past, P(t0,ti-1)/P(t0,ti) otherwise
+    int fromDay = (i > 0) ? this->endDays[i - 1] : this->startDay;
+    double start = (fromDay < 0) ? this->getStartGrowthFactor() : interpolateDiscountFactor<I>(curve, fromDay / 360.0);
+    double growthFactor = start / interpolateDiscountFactor<I>(curve, this->paymentTimes[i]);
+    return (growthFactor - 1) * 360.0 / (this->endDays[i] - fromDay);
+}
+
+template <class T, class I>
+void OIS<T, I>::setPreviousDiscountFactors(vector<DiscountFactor> &prevDiscountFactors)
+{
+    this->previousDiscountFactors = prevDiscountFactors;
+}
+
+template <class T, class I>
+DiscountFactor OIS<T, I>::getDiscountFactor()
+{
+    DiscountFactorCurve curve;
+    for (int i = 0; i < this->previousDiscountFactors.size(); ++i)
+    {
+        curve.addPoint(this->previousDiscountFactors[i].getYearsFromPresentValue(), this->previousDiscountFactors[i].getDiscountFactor());
+    }
+    return this->getDiscountFactor(curve);
+}
+
+#endif //SQF_OIS_H
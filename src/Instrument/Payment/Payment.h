@@ -3,7 +3,10 @@
 
 #include <cmath>
 #include <iostream>
+#include <Compounding/Compounding.h>
 
+// C: compounding of the zero coupon rate used to discount the payment (continuous by default)
+template <class C = ContinuousCompounding>
 class Payment
 {
     private:
@@ -38,14 +41,19 @@ class Payment
             // intYieldCoupon will be:
             // Fix payment: the fix interest rate for the period the fix leg pays
             // Float payment: the forward rate obtained from the zero coupon yield curve for the period the float leg pays
-            return (this->nominal * this->intYieldCoupon * this->numOfYearsFromLastPayment * exp(-this->intRate * this->numOfYearsFromNow));
+            return (this->nominal * this->intYieldCoupon * this->numOfYearsFromLastPayment * this->getDiscountFactor());
         }
 
+        // Curve dependent data: refreshed in place when the curve changes (the rest of the payment does not depend on it)
+        void setInterestRate(double _intRate){ this->intRate = _intRate;}
+        void setForward(double _forward){ this->intYieldCoupon = _forward;}
+
         // Getters
-        double getForward(){ return this->intYieldCoupon;}
-        double getNumOfYearsFromPresentValue(){ return this->numOfYearsFromNow;}
-        double getDayCountFromLastPayment(){ return this->numOfYearsFromLastPayment;}
-        double getDiscountFactor(){ return exp(-this->intRate * this->numOfYearsFromNow);}
+        double getNominal() const { return this->nominal;}
+        double getForward() const { return this->intYieldCoupon;}
+        double getNumOfYearsFromPresentValue() const { return this->numOfYearsFromNow;}
+        double getDayCountFromLastPayment() const { return this->numOfYearsFromLastPayment;}
+        double getDiscountFactor() const { return C::discountFactor(this->intRate, this->numOfYearsFromNow);}
 
 };
 
@@ -0,0 +1,145 @@
+#ifndef SQF_SCHEDULEDSWAP_H
+#define SQF_SCHEDULEDSWAP_H
+
+#include <Instrument/Instrument.h>
+#include <DiscountFactorBootstrap/DiscountFactorCurve.h>
+#include <DiscountFactorBootstrap/DiscountFactorInterpolation.h>
+#include <cmath>
+#include <ctime>
+#include <vector>
+
+// Swap bootstrapped on its real fix leg schedule (calendar adjusted payment dates that need not be pillars of the
+// curve). The par condition is
+// S(t0,tn) * sum of b(t{i-1},ti)*P(t0,ti) + P(t0,tn) = 1
+// The discount factors of the payment dates before the last pillar of the curve are read from the curve, and the
+// ones after it depend on the new pillar P(t0,tn) through the interpolation policy I, so they are solved together
+// with Newton. The schedule is stored once in the constructor: solving does not allocate memory.
+// The pillars are exact for the interpolation I (to price the swap read the curve with interpolateDiscountFactor<I>)
+template <class T, class I = LogLinearDiscountFactorInterpolation>
+class ScheduledSwap : public Instrument
+{
+    private:
+        double swapFixInterestRate;        // S(t0,tn)
+        std::vector<double> paymentTimes;  // b(t0,ti) of the fix leg payments
+        std::vector<double> accruals;      // b(t{i-1},ti)
+        double tolerance;                  // Newton tolerance on the par condition
+        int maxIterations;
+
+        void setSchedule();
+    public:
+        ScheduledSwap(double fixIntRate, std::vector<double> _paymentTimes);
+        ScheduledSwap(T dayCount, double fixIntRate, std::tm presentValue, std::vector<std::tm> paymentDates);
+
+        DiscountFactor getDiscountFactor(const DiscountFactorCurve& curve);
+        DiscountFactor getDiscountFactor();  // From the previous discount factors (see setPreviousDiscountFactors)
+        void setPreviousDiscountFactors(vector<DiscountFactor> &prevDiscountFactors);
+
+        // S(t0,tn) * sum of b(t{i-1},ti)*P(t0,ti) + P(t0,tn) - 1 on a built curve (zero if the swap reprices to par)
+        double computeParResidual(const DiscountFactorCurve& curve);
+
+        int getNumberOfPayments(){ return this->paymentTimes.size();}
+};
+
+// Constructor given the payment dates of the fix leg in years from the present value
+template <class T, class I>
+ScheduledSwap<T, I>::ScheduledSwap(double fixIntRate, std::vector<double> _paymentTimes)
+{
+    this->swapFixInterestRate = fixIntRate;
+    this->paymentTimes = _paymentTimes;
+    this->setSchedule();
+}
+
+// Constructor given the payment dates of the fix leg
+template <class T, class I>
+ScheduledSwap<T, I>::ScheduledSwap(T dayCount, double fixIntRate, std::tm presentValue, std::vector<std::tm> paymentDates)
+{
+    this->swapFixInterestRate = fixIntRate;
+    for (int i = 0; i < paymentDates.size(); ++i)
+    {
+        this->paymentTimes.push_back(dayCount.compute_daycount(presentValue, paymentDates[i]) / 360);
+    }
+    this->setSchedule();
+}
+
+template <class T, class I>
+void ScheduledSwap<T, I>::setSchedule()
+{
+    double lastTime = 0;
+    for (int i = 0; i < this->paymentTimes.size(); ++i)
+    {
+        this->accruals.push_back(this->paymentTimes[i] - lastTime);
+        lastTime = this->paymentTimes[i];
+    }
+
+    // The last payment date is the pillar of the swap. It will be useful to order instruments by their finalization date
+    this->setNumberOfYearsLastPayment(lastTime);
+    this->tolerance = 1e-15;
+    this->maxIterations = 50;
+}
+
+template <class T, class I>
+DiscountFactor ScheduledSwap<T, I>::getDiscountFactor(const DiscountFactorCurve& curve)
+{
+    // Payments up to the last pillar of the curve are known
+    double lastTime = curve.getLastTime();
+    double lastDiscountFactor = (curve.getIncrement() > 0) ? curve.getDiscountFactor(curve.getIncrement() - 1).getDiscountFactor() : 1;
+    double knownLeg = 0;
+    int firstUnknown = 0;
+    while (firstUnknown < this->paymentTimes.size() && this->paymentTimes[firstUnknown] <= lastTime)
+    {
+        knownLeg = knownLeg + this->accruals[firstUnknown] * interpolateDiscountFactor<I>(curve, this->paymentTimes[firstUnknown]);
+        firstUnknown = firstUnknown + 1;
+    }
+
+    // Newton on P(t0,tn): f(P) = S*(knownLeg + sum of b*P(t0,ti)) + P - 1, where P(t0,ti) are interpolated between
+    // the last pillar and P. The first guess is the discount factor with the same forward rate as the last pillar
+    double pillar = this->getNumberOfYearsLastPayment();
+    double discountFactor = (lastTime > 0) ? pow(lastDiscountFactor, pillar / lastTime) : 1 / (1 + this->swapFixInterestRate * pillar);
+    for (int iteration = 0; iteration < this->maxIterations; ++iteration)
+    {
+        double leg = knownLeg;
+        double legDerivative = 0;
+        for (int i = firstUnknown; i < this->paymentTimes.size(); ++i)
+        {
+            leg = leg + this->accruals[i] * I::value(lastTime, lastDiscountFactor, pillar, discountFactor, this->paymentTimes[i]);
+            legDerivative = legDerivative + this->accruals[i] * I::derivative(lastTime, lastDiscountFactor, pillar, discountFactor, this->paymentTimes[i]);
+        }
+        double residual = this->swapFixInterestRate * leg + discountFactor - 1;
+        if (std::abs(residual) <= this->tolerance)
+        {
+            break;
+        }
+        discountFactor = discountFactor - residual / (this->swapFixInterestRate * legDerivative + 1);
+    }
+    return DiscountFactor(pillar, discountFactor);
+}
+
+template <class T, class I>
+double ScheduledSwap<T, I>::computeParResidual(const DiscountFactorCurve& curve)
+{
+    double leg = 0;
+    for (int i = 0; i < this->paymentTimes.size(); ++i)
+    {
+        leg = leg + this->accruals[i] * interpolateDiscountFactor<I>(curve, this->paymentTimes[i]);
+    }
+    return this->swapFixInterestRate * leg + interpolateDiscountFactor<I>(curve, this->getNumberOfYearsLastPayment()) - 1;
+}
+
+template <class T, class I>
+void ScheduledSwap<T, I>::setPreviousDiscountFactors(vector<DiscountFactor> &prevDiscountFactors)
+{
+    this->previousDiscountFactors = prevDiscountFactors;
+}
+
+template <class T, class I>
+DiscountFactor ScheduledSwap<T, I>::getDiscountFactor()
+{
+    DiscountFactorCurve curve;
+    for (int i = 0; i < this->previousDiscountFactors.size(); ++i)
+    {
+        curve.addPoint(this->previousDiscountFactors[i].getYearsFromPresentValue(), this->previousDiscountFactors[i].getDiscountFactor());
+    }
+    return this->getDiscountFactor(curve);
+}
+
+#endif //SQF_SCHEDULEDSWAP_H
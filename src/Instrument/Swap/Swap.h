@@ -1,43 +1,94 @@
 #ifndef SWAP_H
 #define SWAP_H
 
+#include <memory>
+#include <stdexcept>
 #include <vector>
 #include <Date/Actual_360.h>
 #include <Date/Thirty_360.h>
 #include <Instrument/Instrument.h>
 #include <Instrument/Payment/Payment.h>
 #include <ZeroCouponYieldCurve/ZeroCouponYieldCurve.h>
+#include <CurveRegistry/CurveRegistry.h>
+
+// Measures of a swap receiving the fix leg, computed together with one discount factor per payment date
+struct SwapAnalytics
+{
+    double fixLegPresentValue;
+    double floatLegPresentValue;
+    double presentValue;        // Fix leg - float leg
+    double annuity;             // Nominal * sum of b(t{i-1},ti)*P(t0,ti): value of a fix rate of 1
+    double parRate;             // Fix rate that gives a present value of 0
+    double pv01;                // Change of the present value for a fix rate 1 basis point higher
+};
 
 template <class T>
 class Swap : public Instrument
 {
     private:
+        typedef Payment<typename CurveCompounding<T>::type> LegPayment;  // Discounted with the curve compounding
+
         // SWAP VALUATION //
-        T zeroCoupon;                          // Object of type zeroCoupon
-        double nominal;                        // Nominal
-        std::tm presentValueDate;              // Valuation date
-        std::tm lastPaymentDate;               // Date of the last payment occurrence
-        std::vector<Payment> FixPayment;       // Fix Leg
-        std::vector<Payment> VariablePayment;  // Float Leg
+        std::shared_ptr<const T> zeroCoupon;      // Curve of the single curve swaps (shared: it lives as long as the swap)
+        CurveRegistry<T>* registry;               // Registry of the multi-curve swaps (not owned, nullptr otherwise)
+        double nominal;                           // Nominal
+        std::tm presentValueDate;                 // Valuation date
+        std::tm lastPaymentDate;                  // Date of the last payment occurrence
+        std::vector<LegPayment> FixPayment;       // Fix Leg
+        std::vector<LegPayment> VariablePayment;  // Float Leg
+        int discountCurveId;                      // Id of the discount curve in the CurveRegistry (multi-curve swaps)
+        int forwardCurveId;                       // Id of the forward curve in the CurveRegistry (multi-curve swaps)
+
+        // The legs of a payment calendar are generated on first use. Then only their curve dependent data (zero
+        // coupon rates and forwards) is refreshed when the curves change
+        std::vector<std::tm> paymentCalendar;     // Payment dates of both legs (empty if the legs are given)
+        double legFixInterestRate;                // Rate of the fix leg
+        unsigned long legsDiscountVersion;        // Versions of the curves the legs were read from
+        unsigned long legsForwardVersion;
+        unsigned long legsReplacements;           // Curves replaced in the registry when the legs were read
+        int numLegGenerations;                    // Number of times the legs were generated
+        int numLegRefreshes;                      // Number of times the legs were read again from changed curves
+
+        const T& getDiscountCurve();
+        const T& getForwardCurve();
+        void generateLegs();                      // Day counts and payments (curve invariant) and their rates
+        void refreshLegs();                       // Rates and forwards only: no day counts nor allocations
+        void setLegsVersions();
+        void materializeLegs();                   // Generate or refresh the legs if they are missing or the curves changed
         // SWAP DISCOUNT FACTOR //
-        double swapFixInterestRate;            // Interest rate between present date and last payment date S(t0,tn)
+        double swapFixInterestRate;               // Interest rate between present date and last payment date S(t0,tn)
     public:
         // SWAP VALUATION //
+        // The swap keeps a copy of the curve: later changes of _zeroCoupon are not seen by the swap
         Swap(double _nominal, T& _zeroCoupon, std::tm lastPayment);
         Swap(double _nominal, T& _zeroCoupon, vector<std::tm> _paymentCalendar, double fixInterestRate);
+        // The swap shares the curve: the legs follow its changes (updateRate, computeZeroCurve...)
+        Swap(double _nominal, std::shared_ptr<const T> _zeroCoupon, std::tm lastPayment);
+        Swap(double _nominal, std::shared_ptr<const T> _zeroCoupon, vector<std::tm> _paymentCalendar, double fixInterestRate);
+        // Multi-curve swap. Throws std::invalid_argument if a key is not registered
+        Swap(double _nominal, CurveRegistry<T>& registry, CurveKey discountKey, CurveKey forwardKey,
+             vector<std::tm> _paymentCalendar, double fixInterestRate);
         ~Swap();
 
         double computePresentValue();
+        // Leg values, annuity, par rate and PV01 in one pass over the legs (instead of valuing again with other rates)
+        SwapAnalytics computeAnalytics();
         void floatPaymentValuations(double numOfPaymentsPerYear);
         void fixPaymentValuations(double interest, double numOfPaymentsPerYear);
 
-        // Getters
-        double getVariablePaymentValue(int i){ return this->VariablePayment[i].value();}
-        double getFixPaymentValue(int i){ return this->FixPayment[i].value();}
+        // Getters (the legs are generated if needed)
+        double getVariablePaymentValue(int i){ this->materializeLegs(); return this->VariablePayment[i].value();}
+        double getFixPaymentValue(int i){ this->materializeLegs(); return this->FixPayment[i].value();}
 
-        double getVariableForward(int i){ return VariablePayment[i].getForward();}
-        double getDayCountFromLastPayment(int i){ return VariablePayment[i].getDayCountFromLastPayment();}
-        double getDiscountFactor(int i){ return VariablePayment[i].getDiscountFactor();}
+        double getVariableForward(int i){ this->materializeLegs(); return VariablePayment[i].getForward();}
+        double getDayCountFromLastPayment(int i){ this->materializeLegs(); return VariablePayment[i].getDayCountFromLastPayment();}
+        double getDiscountFactor(int i){ this->materializeLegs(); return VariablePayment[i].getDiscountFactor();}
+        int getDiscountCurveId(){ return this->discountCurveId;}
+        int getForwardCurveId(){ return this->forwardCurveId;}
+        const std::vector<LegPayment>& getFixPayments(){ this->materializeLegs(); return this->FixPayment;}
+        const std::vector<LegPayment>& getVariablePayments(){ this->materializeLegs(); return this->VariablePayment;}
+        int getNumberOfLegGenerations(){ return this->numLegGenerations;}
+        int getNumberOfLegRefreshes(){ return this->numLegRefreshes;}
 
 
         // SWAP DISCOUNT FACTOR //
@@ -49,49 +100,195 @@ class Swap : public Instrument
         void setPreviousDiscountFactors(vector<DiscountFactor> &prevDiscountFactors);
         DiscountFactor getDiscountFactor();  // P(t0,tn)
 
+        // P(t0,tn) from the running annuity of the curve built with the instruments that end before the swap (O(1))
+        DiscountFactor getDiscountFactor(const DiscountFactorCurve& curve);
+        DiscountFactor getDiscountFactor(double annuity, double lastTime);
+        ParCondition getParCondition();  // S(t0,tn)*A(tn) + P(t0,tn) - 1
+        ParCondition getParConditionQuoteDerivative();
+
 };
 
+// EQUATION 3.6 with the summation already done: annuity = sum of b(t{i-1},ti)*P(t0,ti) up to the last known date
+// lastTime, and yearly payments from there to tn. Shared by Swap and InstrumentArena
+double computeSwapDiscountFactor(double swapFixInterestRate, double lastPaymentInYears, double annuity, double lastTime)
+{
+    return (1 - swapFixInterestRate * annuity) / (1 + swapFixInterestRate * (lastPaymentInYears - lastTime));
+}
+
 // SWAP VALUATION //
 template <class T>
 Swap<T>::Swap(double _nominal, T& _zeroCoupon, std::tm _lastPayment)
+    : Swap(_nominal, std::make_shared<const T>(_zeroCoupon), _lastPayment)
+{
+}
+
+template <class T>
+Swap<T>::Swap(double _nominal, T& _zeroCoupon, vector<std::tm> _paymentCalendar, double fixInterestRate)
+    : Swap(_nominal, std::make_shared<const T>(_zeroCoupon), _paymentCalendar, fixInterestRate)
+{
+}
+
+template <class T>
+Swap<T>::Swap(double _nominal, std::shared_ptr<const T> _zeroCoupon, std::tm _lastPayment)
 {
     this->nominal= _nominal;
     this->zeroCoupon = _zeroCoupon;
-    this->presentValueDate = _zeroCoupon.getPresentValue();
+    this->registry = nullptr;
+    this->discountCurveId = -1;
+    this->forwardCurveId = -1;
+    this->presentValueDate = _zeroCoupon->getPresentValue();
     this->lastPaymentDate = _lastPayment;
+    this->numLegGenerations = 0;
+    this->numLegRefreshes = 0;
 }
 
 template <class T>
-Swap<T>::Swap(double _nominal, T& _zeroCoupon, vector<std::tm> _paymentCalendar, double fixInterestRate)
+Swap<T>::Swap(double _nominal, std::shared_ptr<const T> _zeroCoupon, vector<std::tm> _paymentCalendar, double fixInterestRate)
 {
-    // Compute payments from a date vector which contains the payment dates (_paymentCalendar)
+    // Keep the payment dates (_paymentCalendar): the payments are computed when the swap is valued (materializeLegs)
     this->nominal= _nominal;
     this->zeroCoupon = _zeroCoupon;  // ZeroCouponCurve
-    this->presentValueDate = _zeroCoupon.getPresentValue();
+    this->registry = nullptr;
+    this->discountCurveId = -1;
+    this->forwardCurveId = -1;
+    this->presentValueDate = _zeroCoupon->getPresentValue();
+    this->lastPaymentDate = _paymentCalendar.back();
+    this->paymentCalendar = _paymentCalendar;
+    this->legFixInterestRate = fixInterestRate;
+    this->numLegGenerations = 0;
+    this->numLegRefreshes = 0;
+}
+
+template <class T>
+Swap<T>::Swap(double _nominal, CurveRegistry<T>& registry, CurveKey discountKey, CurveKey forwardKey,
+              vector<std::tm> _paymentCalendar, double fixInterestRate)
+{
+    // Multi-curve swap: both legs are discounted with the discount curve (OIS) and the float leg forwards are
+    // projected with the forward curve of the index tenor. The curves are resolved by key only once, here
+    this->discountCurveId = registry.getDiscountCurveId(discountKey);
+    this->forwardCurveId = registry.getForwardCurveId(forwardKey);
+    if (this->discountCurveId < 0 || this->forwardCurveId < 0)
+    {
+        throw std::invalid_argument("Swap: curve not registered (" + discountKey.currency + "/" + discountKey.index + "/" +
+                                    discountKey.tenor + ", " + forwardKey.currency + "/" + forwardKey.index + "/" +
+                                    forwardKey.tenor + ")");
+    }
+    this->registry = &registry;
+    this->zeroCoupon = nullptr;
+
+    this->nominal = _nominal;
+    this->presentValueDate = registry.getDiscountCurve(this->discountCurveId).getPresentValue();
     this->lastPaymentDate = _paymentCalendar.back();
+    this->paymentCalendar = _paymentCalendar;
+    this->legFixInterestRate = fixInterestRate;
+    this->numLegGenerations = 0;
+    this->numLegRefreshes = 0;
+}
+
+template <class T>
+const T& Swap<T>::getDiscountCurve()
+{
+    // The registry is read by id every time: its vectors may have grown since the swap was built
+    return (this->registry != nullptr) ? this->registry->getDiscountCurve(this->discountCurveId) : *this->zeroCoupon;
+}
+
+template <class T>
+const T& Swap<T>::getForwardCurve()
+{
+    return (this->registry != nullptr) ? this->registry->getForwardCurve(this->forwardCurveId) : *this->zeroCoupon;
+}
+
+template <class T>
+void Swap<T>::materializeLegs()
+{
+    if (this->paymentCalendar.empty())
+    {
+        return;  // Legs given with fixPaymentValuations and floatPaymentValuations
+    }
+    if (this->numLegGenerations == 0)
+    {
+        this->generateLegs();
+        return;
+    }
+    unsigned long replacements = (this->registry != nullptr) ? this->registry->getNumberOfReplacements() : 0;
+    if (this->legsDiscountVersion != this->getDiscountCurve().getVersion() ||
+        this->legsForwardVersion != this->getForwardCurve().getVersion() || this->legsReplacements != replacements)
+    {
+        this->refreshLegs();
+    }
+}
+
+template <class T>
+void Swap<T>::generateLegs()
+{
+    const T& discountCurve = this->getDiscountCurve();
+    const T& forwardCurve = this->getForwardCurve();
+    this->FixPayment.clear();
+    this->VariablePayment.clear();
 
     // Initialize date variables: Delta(t) = dateInYears - lastDateInYears
     double dateInYears = 0;
     double lastDateInYears = 0;
+    std::tm lastDate = this->presentValueDate;
 
     // Add payment object to FixPayment vector (this object has the methods of the Payment class)
-    for(int i = 0; i<_paymentCalendar.size(); ++i)
+    for(int i = 0; i<this->paymentCalendar.size(); ++i)
     {
         // Update dates when the payments occur
         // getTimeInYearsFromPresentDate: Diff in years from paymentCalendar[i] to initialDate (class attribute of zeroCouponYieldCurve which represents the present date)
         // getInterpolatedZCRate: interest rate from yield curve for the period in years by interpolating methods
-        // getForward(i): computes the forward interest rate between lastDateInYears and dateInYears
         lastDateInYears = dateInYears;
-        dateInYears = zeroCoupon.getTimeInYearsFromPresentDate(_paymentCalendar[i]);
-        FixPayment.push_back(Payment(this->nominal, this->zeroCoupon.getInterpolatedZCRate(dateInYears), fixInterestRate, dateInYears, dateInYears - lastDateInYears));
-        VariablePayment.push_back(Payment(this->nominal, this->zeroCoupon.getInterpolatedZCRate(dateInYears), this->zeroCoupon.getForward(i), dateInYears, dateInYears - lastDateInYears ));
+        dateInYears = discountCurve.getTimeInYearsFromPresentDate(this->paymentCalendar[i]);
+        double discountRate = discountCurve.getInterpolatedZCRate(dateInYears);
+
+        // Single curve: getForward(i) is the forward of the ith period of the curve. Multi-curve: the forward between
+        // the previous and the current payment date from the forward curve (the payment dates need not match the
+        // forward curve pillars)
+        double forward = (this->registry != nullptr) ? forwardCurve.getForward(lastDate, this->paymentCalendar[i]) : forwardCurve.getForward(i);
+        FixPayment.push_back(LegPayment(this->nominal, discountRate, this->legFixInterestRate, dateInYears, dateInYears - lastDateInYears));
+        VariablePayment.push_back(LegPayment(this->nominal, discountRate, forward, dateInYears, dateInYears - lastDateInYears));
+        lastDate = this->paymentCalendar[i];
     }
+    this->setLegsVersions();
+    this->numLegGenerations = this->numLegGenerations + 1;
+}
+
+template <class T>
+void Swap<T>::refreshLegs()
+{
+    // The payment times, accruals, nominal and fix rate do not depend on the curves: read again only the zero coupon
+    // rates and the forwards, in place. The forward curve shares the present date of the discount curve, so the
+    // times of the payments are also the times in the forward curve
+    const T& discountCurve = this->getDiscountCurve();
+    const T& forwardCurve = this->getForwardCurve();
+    double lastDateInYears = 0;
+    for(int i = 0; i<this->FixPayment.size(); ++i)
+    {
+        double dateInYears = this->FixPayment[i].getNumOfYearsFromPresentValue();
+        double discountRate = discountCurve.getInterpolatedZCRate(dateInYears);
+        double forward = (this->registry != nullptr) ? forwardCurve.getForward(lastDateInYears, dateInYears) : forwardCurve.getForward(i);
+        this->FixPayment[i].setInterestRate(discountRate);
+        this->VariablePayment[i].setInterestRate(discountRate);
+        this->VariablePayment[i].setForward(forward);
+        lastDateInYears = dateInYears;
+    }
+    this->setLegsVersions();
+    this->numLegRefreshes = this->numLegRefreshes + 1;
+}
+
+template <class T>
+void Swap<T>::setLegsVersions()
+{
+    this->legsDiscountVersion = this->getDiscountCurve().getVersion();
+    this->legsForwardVersion = this->getForwardCurve().getVersion();
+    this->legsReplacements = (this->registry != nullptr) ? this->registry->getNumberOfReplacements() : 0;
 }
 
 template <class T>
 double Swap<T>::computePresentValue()
 {
     // First compute the fix leg (first loop or sumation), and then subtract the variable payments
+    this->materializeLegs();
     double ret = 0;
     for(int i=0;i<FixPayment.size();i++)
     {
@@ -104,12 +301,45 @@ double Swap<T>::computePresentValue()
     return ret;
 }
 
+template <class T>
+SwapAnalytics Swap<T>::computeAnalytics()
+{
+    // Both legs pay on the same dates: the discount factor of each date is computed once and used by both legs
+    this->materializeLegs();
+    SwapAnalytics analytics = SwapAnalytics();
+    for(int i=0;i<FixPayment.size();i++)
+    {
+        double discountFactor = FixPayment[i].getDiscountFactor();
+        analytics.fixLegPresentValue = analytics.fixLegPresentValue + FixPayment[i].value() * discountFactor;
+        analytics.floatLegPresentValue = analytics.floatLegPresentValue + VariablePayment[i].value() * discountFactor;
+        analytics.annuity = analytics.annuity + FixPayment[i].getNominal() * FixPayment[i].getDayCountFromLastPayment() * discountFactor;
+    }
+    analytics.presentValue = analytics.fixLegPresentValue - analytics.floatLegPresentValue;
+    analytics.parRate = (analytics.annuity != 0) ? analytics.floatLegPresentValue / analytics.annuity : 0;
+    analytics.pv01 = analytics.annuity * 1e-4;
+    return analytics;
+}
+
+// Analytics of a set of swaps, for example a grid of quotes (every start and tenor): a single pass over the payments
+// of each swap, with its legs generated or refreshed only if needed
+template <class T>
+void computeSwapAnalytics(const std::vector<Swap<T>*>& swaps, std::vector<SwapAnalytics>& analytics)
+{
+    analytics.resize(swaps.size());
+    for (int i = 0; i < swaps.size(); ++i)
+    {
+        analytics[i] = swaps[i]->computeAnalytics();
+    }
+}
+
 template <class T>
 void Swap<T>::fixPaymentValuations(double interest, double numOfPaymentsPerYear)
 {
     // Compute fractional payments for fix leg (look at bond implementation)
+    // Single and multi-curve swaps read their curves the same way (the registry swaps have no single curve)
+    const T& discountCurve = this->getDiscountCurve();
     std::tm date;
-    int lastPayment = (int)round(zeroCoupon.getTimeInDayCountConvention(this->lastPaymentDate));
+    int lastPayment = (int)round(discountCurve.getTimeInYearsFromPresentDate(this->lastPaymentDate));
     double fracNumPaymentsPerYear = 1/(numOfPaymentsPerYear);
 
     double dateInYears = 0;
@@ -118,9 +348,9 @@ void Swap<T>::fixPaymentValuations(double interest, double numOfPaymentsPerYear)
     for(double i=fracNumPaymentsPerYear; i <=lastPayment; i=i+fracNumPaymentsPerYear)
     {
         lastDateInYears = dateInYears;
-        date = zeroCoupon.getDayCountConvention().generate_tm(this->presentValueDate, i);
+        date = discountCurve.getDayCountConvention().generate_tm(this->presentValueDate, i);
         cout<<"dd/mm/yyyy: "<<date.tm_mday<<"/"<<date.tm_mon+1<<"/"<<date.tm_year+1900<<endl;
-        FixPayment.push_back(Payment(this->nominal, this->zeroCoupon.getInterpolatedZCRate(i), interest, dateInYears, fracNumPaymentsPerYear )); // Definición de un pago
+        FixPayment.push_back(LegPayment(this->nominal, discountCurve.getInterpolatedZCRate(i), interest, dateInYears, fracNumPaymentsPerYear )); // Definición de un pago
     }
     cout<<"\n"<<endl;
 }
@@ -129,8 +359,10 @@ template <class T>
 void Swap<T>::floatPaymentValuations(double numOfPaymentsPerYear)
 {
     // Compute fractional payments for float leg (get the forward interest rate from the zero coupon curve)
+    const T& discountCurve = this->getDiscountCurve();
+    const T& forwardCurve = this->getForwardCurve();
     std::tm date;
-    int lastPayment = (int)round(zeroCoupon.getTimeInDayCountConvention(this->lastPaymentDate));
+    int lastPayment = (int)round(discountCurve.getTimeInYearsFromPresentDate(this->lastPaymentDate));
     double fracNumPaymentsPerYear = 1/(numOfPaymentsPerYear);
 
     double dateInYears = 0;
@@ -139,8 +371,8 @@ void Swap<T>::floatPaymentValuations(double numOfPaymentsPerYear)
     for(double i=fracNumPaymentsPerYear; i <=lastPayment; i=i+fracNumPaymentsPerYear)
     {
         lastDateInYears = dateInYears;
-        date = zeroCoupon.getDayCountConvention().generate_tm(this->presentValueDate, i);
-        VariablePayment.push_back(Payment(this->nominal, this->zeroCoupon.getInterpolatedZCRate(i), this->zeroCoupon.getForward(this->presentValueDate, date), dateInYears, fracNumPaymentsPerYear )); // Definición de un pago
+        date = discountCurve.getDayCountConvention().generate_tm(this->presentValueDate, i);
+        VariablePayment.push_back(LegPayment(this->nominal, discountCurve.getInterpolatedZCRate(i), forwardCurve.getForward(this->presentValueDate, date), dateInYears, fracNumPaymentsPerYear )); // Definición de un pago
     }
     cout<<"\n"<<endl;
 }
@@ -151,6 +383,10 @@ Swap<T>::Swap(double fixIntRate, double numOfMonth)
 {
     // Constructor given the number of months between present date and last payment date
     this->swapFixInterestRate = fixIntRate;  // S(t0,tn)
+    this->zeroCoupon = nullptr;                // Not valued: no legs
+    this->registry = nullptr;
+    this->numLegGenerations = 0;
+    this->numLegRefreshes = 0;
 
     // Compute time in years between the actual date and the date of the last payment
     double lastPaymentInYears = numOfMonth / 12;  // b(t0,tn)
@@ -165,6 +401,10 @@ Swap<T>::Swap(T dayCount, double fixIntRate, std::tm startDate, std::tm endDate)
 {
     // Constructor given the starting date and the end date of the swap payments
     this->swapFixInterestRate = fixIntRate;  // S(t0,tn)
+    this->zeroCoupon = nullptr;                // Not valued: no legs
+    this->registry = nullptr;
+    this->numLegGenerations = 0;
+    this->numLegRefreshes = 0;
 
     // Compute time in years between the actual date and the date of the last payment
     double lastPaymentInYears = dayCount.compute_daycount(startDate, endDate)/360;  // b(t0,tn)
@@ -185,8 +425,7 @@ template <class T>
 DiscountFactor Swap<T>::getDiscountFactor()
 {
     // Compute discount factor (EQUATION 3.6)
-    double numberOfYearsBetweenPayments = 0;
-    double sum = 0;  // Accumulator for the summation in EQ 3.6
+    double annuity = 0;  // Accumulator for the summation in EQ 3.6 (without the swap rate)
 
     // Create and initialize the attributes of the discount factor objects to zero
     DiscountFactor actualDF = DiscountFactor();
@@ -196,12 +435,36 @@ DiscountFactor Swap<T>::getDiscountFactor()
     for(int i = 0; i<this->previousDiscountFactors.size(); ++i)
     {
         actualDF = previousDiscountFactors[i];  //Get actual discount factor to work with it
-        sum = sum + this->swapFixInterestRate * (actualDF.getYearsFromPresentValue() - previousDF.getYearsFromPresentValue()) * actualDF.getDiscountFactor();
+        annuity = annuity + (actualDF.getYearsFromPresentValue() - previousDF.getYearsFromPresentValue()) * actualDF.getDiscountFactor();
         previousDF = actualDF;
     }
-    sum = (1 - sum)/(1 + this->swapFixInterestRate * (this->getNumberOfYearsLastPayment() - actualDF.getYearsFromPresentValue()));
+    return this->getDiscountFactor(annuity, actualDF.getYearsFromPresentValue());
+}
+
+template <class T>
+DiscountFactor Swap<T>::getDiscountFactor(const DiscountFactorCurve& curve)
+{
+    return this->getDiscountFactor(curve.getAnnuity(), curve.getLastTime());
+}
+
+template <class T>
+DiscountFactor Swap<T>::getDiscountFactor(double annuity, double lastTime)
+{
+    double discountFactor = computeSwapDiscountFactor(this->swapFixInterestRate, this->getNumberOfYearsLastPayment(), annuity, lastTime);
+    return DiscountFactor(this->getNumberOfYearsLastPayment(), discountFactor);
+}
 
-    return DiscountFactor(this->getNumberOfYearsLastPayment(), sum);
+template <class T>
+ParCondition Swap<T>::getParCondition()
+{
+    // EQUATION 3.6 with the annuity up to tn: the fix leg plus the nominal at tn is worth the nominal today
+    return ParCondition{-1, 1, this->swapFixInterestRate, 0, 0};
+}
+
+template <class T>
+ParCondition Swap<T>::getParConditionQuoteDerivative()
+{
+    return ParCondition{0, 0, 1, 0, 0};
 }
 
 template <class T>
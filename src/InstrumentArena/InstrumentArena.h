@@ -0,0 +1,216 @@
+#ifndef SQF_INSTRUMENTARENA_H
+#define SQF_INSTRUMENTARENA_H
+
+#include <Instrument/Deposit/Deposit.h>
+#include <Instrument/FRA/FRA.h>
+#include <Instrument/Swap/Swap.h>
+#include <Compounding/Compounding.h>
+#include <DiscountFactorBootstrap/DiscountFactorCurve.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Records of the instruments used to build the discount factor curve: only the data of the instrument (no vtable, no
+// vectors), so they are trivially destructible and many of them fit in a cache line
+struct DepositRecord
+{
+    double interestRate;        // R(t0,ti)
+    double lastPaymentInYears;  // b(t0,ti)
+};
+
+struct FRARecord
+{
+    double fraInterestRate;     // f(t0,t1,t2)
+    double startDateInYears;    // b(t0,t1)
+    double dayCountFactor;      // b(t1,t2)
+    double lastPaymentInYears;  // b(t0,t2)
+};
+
+struct SwapRecord
+{
+    double swapFixInterestRate; // S(t0,tn)
+    double lastPaymentInYears;  // b(t0,tn)
+};
+
+// Entry of the type-tagged table: the last payment date (sort key), the kind of the record and where it is
+struct InstrumentEntry
+{
+    enum Kind { DEPOSIT, FRA, SWAP };
+    double lastPaymentInYears;
+    Kind kind;
+    const void* record;
+};
+
+bool compareEntryEndPeriods(const InstrumentEntry& a, const InstrumentEntry& b)
+{
+    // Same order as compareEndPeriods, on the compact entries instead of through the instrument pointers
+    return (a.lastPaymentInYears < b.lastPaymentInYears);
+}
+
+// Storage of the instruments of a curve build without one new per instrument: the records of all the kinds are placed
+// one after the other in blocks of a monotonic arena, and the discount factors are computed by switching on the kind
+// in the table (no virtual calls). Everything is released at once: release() rewinds the arena in O(1) (the blocks
+// are kept for the next build) and the destructor frees the blocks
+class InstrumentArena
+{
+    private:
+        int blockSize;                      // Bytes of each block
+        std::vector<char*> blocks;
+        int currentBlock;                   // Block where the next record is placed
+        std::size_t offset;                 // First free byte of the current block
+        std::vector<InstrumentEntry> entries;
+
+        template <class R>
+        R* allocate();
+    public:
+        InstrumentArena(int _blockSize = 1 << 16);
+        ~InstrumentArena();
+        InstrumentArena(const InstrumentArena&) = delete;             // The entries point into the blocks
+        InstrumentArena& operator = (const InstrumentArena&) = delete;
+
+        // Same arguments as the constructors of Deposit, FRA and Swap from numbers of months. Return the index
+        int addDeposit(double interest, double numOfMonth);
+        int addFRA(double interest, double startDateInMonth, double endDateInMonth);
+        int addSwap(double fixIntRate, double numOfMonth);
+
+        void sortByLastPayment();
+        DiscountFactor getDiscountFactor(int i, const DiscountFactorCurve& curve) const;
+        // Sort the instruments and build the curve (as DiscountFactorBootstrap::bootstrap)
+        DiscountFactorCurve bootstrap();
+        void release();
+
+        int size() const { return this->entries.size();}
+        InstrumentEntry::Kind getKind(int i) const { return this->entries[i].kind;}
+        double getNumberOfYearsLastPayment(int i) const { return this->entries[i].lastPaymentInYears;}
+        int getNumberOfBlocks() const { return this->blocks.size();}
+};
+
+InstrumentArena::InstrumentArena(int _blockSize)
+{
+    this->blockSize = std::max(_blockSize, (int)sizeof(FRARecord));  // The largest record fits in a block
+    this->currentBlock = -1;
+    this->offset = 0;
+}
+
+InstrumentArena::~InstrumentArena()
+{
+    for (int i = 0; i < this->blocks.size(); ++i)
+    {
+        std::free(this->blocks[i]);
+    }
+}
+
+template <class R>
+R* InstrumentArena::allocate()
+{
+    static_assert(std::is_trivially_destructible<R>::value, "Records are released without calling destructors");
+
+    // Bump the offset (aligned), and move to the next block when the record does not fit
+    std::size_t start = (this->offset + alignof(R) - 1) / alignof(R) * alignof(R);
+    if (this->currentBlock < 0 || start + sizeof(R) > this->blockSize)
+    {
+        this->currentBlock = this->currentBlock + 1;
+        if (this->currentBlock == this->blocks.size())
+        {
+            char* block = (char*)std::malloc(this->blockSize);
+            if (block == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            this->blocks.push_back(block);
+        }
+        start = 0;
+    }
+    this->offset = start + sizeof(R);
+    return new (this->blocks[this->currentBlock] + start) R();
+}
+
+int InstrumentArena::addDeposit(double interest, double numOfMonth)
+{
+    DepositRecord* record = this->allocate<DepositRecord>();
+    record->interestRate = interest;
+    record->lastPaymentInYears = numOfMonth / 12;
+    this->entries.push_back(InstrumentEntry{record->lastPaymentInYears, InstrumentEntry::DEPOSIT, record});
+    return this->entries.size() - 1;
+}
+
+int InstrumentArena::addFRA(double interest, double startDateInMonth, double endDateInMonth)
+{
+    FRARecord* record = this->allocate<FRARecord>();
+    record->fraInterestRate = interest;
+    record->startDateInYears = startDateInMonth / 12;
+    record->dayCountFactor = (endDateInMonth - startDateInMonth) / 12;
+    record->lastPaymentInYears = endDateInMonth / 12;
+    this->entries.push_back(InstrumentEntry{record->lastPaymentInYears, InstrumentEntry::FRA, record});
+    return this->entries.size() - 1;
+}
+
+int InstrumentArena::addSwap(double fixIntRate, double numOfMonth)
+{
+    SwapRecord* record = this->allocate<SwapRecord>();
+    record->swapFixInterestRate = fixIntRate;
+    record->lastPaymentInYears = numOfMonth / 12;
+    this->entries.push_back(InstrumentEntry{record->lastPaymentInYears, InstrumentEntry::SWAP, record});
+    return this->entries.size() - 1;
+}
+
+void InstrumentArena::sortByLastPayment()
+{
+    std::sort(this->entries.begin(), this->entries.end(), compareEntryEndPeriods);
+}
+
+DiscountFactor InstrumentArena::getDiscountFactor(int i, const DiscountFactorCurve& curve) const
+{
+    const InstrumentEntry& entry = this->entries[i];
+    double discountFactor = 0;
+    switch (entry.kind)
+    {
+        case InstrumentEntry::DEPOSIT:
+        {
+            // EQUATION 3.1
+            const DepositRecord* deposit = (const DepositRecord*)entry.record;
+            discountFactor = SimpleCompounding::discountFactor(deposit->interestRate, deposit->lastPaymentInYears);
+            break;
+        }
+        case InstrumentEntry::FRA:
+        {
+            const FRARecord* fra = (const FRARecord*)entry.record;
+            discountFactor = computeFRADiscountFactor(fra->fraInterestRate, fra->startDateInYears, fra->dayCountFactor, curve);
+            break;
+        }
+        case InstrumentEntry::SWAP:
+        {
+            const SwapRecord* swap = (const SwapRecord*)entry.record;
+            discountFactor = computeSwapDiscountFactor(swap->swapFixInterestRate, swap->lastPaymentInYears,
+                                                       curve.getAnnuity(), curve.getLastTime());
+            break;
+        }
+    }
+    return DiscountFactor(entry.lastPaymentInYears, discountFactor);
+}
+
+DiscountFactorCurve InstrumentArena::bootstrap()
+{
+    this->sortByLastPayment();
+    DiscountFactorCurve curve;
+    for (int i = 0; i < this->entries.size(); ++i)
+    {
+        DiscountFactor discountFactor = this->getDiscountFactor(i, curve);
+        curve.addPoint(discountFactor.getYearsFromPresentValue(), discountFactor.getDiscountFactor());
+    }
+    curve.interpolate();
+    return curve;
+}
+
+void InstrumentArena::release()
+{
+    // The records are trivially destructible: forgetting them is enough
+    this->entries.clear();
+    this->currentBlock = -1;
+    this->offset = 0;
+}
+
+#endif //SQF_INSTRUMENTARENA_H
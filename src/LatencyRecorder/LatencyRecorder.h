@@ -0,0 +1,77 @@
+#ifndef SQF_LATENCYRECORDER_H
+#define SQF_LATENCYRECORDER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+// Record latencies (in seconds) and report their percentiles. The samples are kept in a ring buffer allocated once,
+// with the first sample, so recording on the hot path does not allocate: when it is full, the oldest samples are
+// overwritten and the percentiles refer to the last capacity samples
+class LatencyRecorder
+{
+    private:
+        int capacity;                 // Maximum number of samples kept
+        std::vector<double> samples;  // Ring buffer of the last samples
+        long numSamples;              // Samples recorded since the start (or the last reset)
+    public:
+        LatencyRecorder(int _capacity = 1 << 16);
+
+        void record(double seconds);
+        void reset(){ this->numSamples = 0;}
+
+        long getNumberOfSamples(){ return this->numSamples;}
+        double getPercentile(double percentile);  // Percentile in [0,100] (nearest rank). 0 if there are no samples
+        double getP50(){ return this->getPercentile(50);}
+        double getP99(){ return this->getPercentile(99);}
+        double getMax(){ return this->getPercentile(100);}
+};
+
+// Measure the lifetime of the object and record it
+class ScopedLatency
+{
+    private:
+        LatencyRecorder& recorder;
+        std::chrono::steady_clock::time_point start;
+    public:
+        ScopedLatency(LatencyRecorder& _recorder): recorder(_recorder), start{std::chrono::steady_clock::now()}{};
+        ~ScopedLatency()
+        {
+            this->recorder.record(std::chrono::duration<double>(std::chrono::steady_clock::now() - this->start).count());
+        }
+};
+
+LatencyRecorder::LatencyRecorder(int _capacity)
+{
+    this->capacity = (_capacity > 0) ? _capacity : 1;
+    this->numSamples = 0;
+}
+
+void LatencyRecorder::record(double seconds)
+{
+    if (this->samples.empty())
+    {
+        this->samples.resize(this->capacity);
+    }
+    this->samples[this->numSamples % this->samples.size()] = seconds;
+    this->numSamples = this->numSamples + 1;
+}
+
+double LatencyRecorder::getPercentile(double percentile)
+{
+    long size = std::min(this->numSamples, (long)this->capacity);
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    // Nearest rank: the smallest sample with at least percentile% of the samples at or below it
+    std::vector<double> sorted(this->samples.begin(), this->samples.begin() + size);
+    long rank = (long)std::ceil(percentile / 100 * size);
+    rank = std::min(std::max(rank, 1L), size);
+    std::nth_element(sorted.begin(), sorted.begin() + rank - 1, sorted.end());
+    return sorted[rank - 1];
+}
+
+#endif //SQF_LATENCYRECORDER_H
@@ -0,0 +1,94 @@
+#ifndef SQF_FIXINGSERIES_H
+#define SQF_FIXINGSERIES_H
+
+#include <vector>
+
+// Published fixings of an overnight index (one per business day). Each fixing accrues with simple interest from its
+// day to the day of the next one (weekends and holidays accrue at the rate of the previous business day).
+// The growth factors of the fixings are kept as prefix products, so the compounded growth between any two days is a
+// quotient, G(d1,d2) = G(d2)/G(d1), and costs O(1) whatever the number of fixings in between (compounding them one by
+// one costs one operation per business day). The days are integers from any origin (the present value in OIS)
+class FixingSeries
+{
+    private:
+        double daysPerYear;             // Day count basis of the index (360 for most overnight indices)
+        std::vector<int> days;          // Day of each fixing (increasing)
+        std::vector<double> rates;      // Fixing rates
+        std::vector<double> growth;     // Prefix products: growth from the first fixing to the day of fixing k
+        std::vector<int> fixingOfDay;   // Fixing in force on each day from the first one (dense, O(1) lookup)
+
+        double getGrowthFactor(int day);  // From the first fixing to day
+    public:
+        FixingSeries(double _daysPerYear = 360);
+
+        // Add the fixing of day (after the last one). Returns -1 if the day is not after the last fixing
+        int addFixing(int day, double rate);
+
+        // Compounded growth factor prod(1 + r*d/daysPerYear) between two days (-1 if fromDay is before the first fixing).
+        // The days after the last fixing accrue at its rate (the last published fixing accrues up to the present)
+        double getGrowthFactor(int fromDay, int toDay);
+        // Compounded rate between two days: (G - 1) * daysPerYear / (toDay - fromDay) (-1 if it can not be computed)
+        double getCompoundedRate(int fromDay, int toDay);
+
+        int getNumberOfFixings(){ return this->days.size();}
+        int getFirstDay(){ return this->days.front();}
+        int getLastDay(){ return this->days.back();}
+        double getRate(int i){ return this->rates[i];}
+        double getDaysPerYear(){ return this->daysPerYear;}
+};
+
+FixingSeries::FixingSeries(double _daysPerYear)
+{
+    this->daysPerYear = _daysPerYear;
+}
+
+int FixingSeries::addFixing(int day, double rate)
+{
+    if (!this->days.empty() && day <= this->days.back())
+    {
+        return -1;
+    }
+
+    // The previous fixing accrues up to this day
+    if (this->days.empty())
+    {
+        this->growth.push_back(1);
+    }
+    else
+    {
+        this->growth.push_back(this->growth.back() * (1 + this->rates.back() * (day - this->days.back()) / this->daysPerYear));
+    }
+    this->days.push_back(day);
+    this->rates.push_back(rate);
+    this->fixingOfDay.resize(day - this->days.front() + 1, this->days.size() - 2);
+    this->fixingOfDay.back() = this->days.size() - 1;
+    return this->days.size() - 1;
+}
+
+double FixingSeries::getGrowthFactor(int day)
+{
+    // Growth up to the fixing in force on day, and simple interest of that fixing for the remaining days
+    int k = (day < this->days.back()) ? this->fixingOfDay[day - this->days.front()] : this->days.size() - 1;
+    return this->growth[k] * (1 + this->rates[k] * (day - this->days[k]) / this->daysPerYear);
+}
+
+double FixingSeries::getGrowthFactor(int fromDay, int toDay)
+{
+    if (this->days.empty() || fromDay < this->days.front() || fromDay > toDay)
+    {
+        return -1;
+    }
+    return this->getGrowthFactor(toDay) / this->getGrowthFactor(fromDay);
+}
+
+double FixingSeries::getCompoundedRate(int fromDay, int toDay)
+{
+    double growthFactor = this->getGrowthFactor(fromDay, toDay);
+    if (growthFactor < 0 || fromDay == toDay)
+    {
+        return -1;
+    }
+    return (growthFactor - 1) * this->daysPerYear / (toDay - fromDay);
+}
+
+#endif //SQF_FIXINGSERIES_H
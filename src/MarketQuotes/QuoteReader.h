@@ -0,0 +1,348 @@
+#ifndef SQF_QUOTEREADER_H
+#define SQF_QUOTEREADER_H
+
+#include <Instrument/Instrument.h>
+#include <Instrument/Deposit/Deposit.h>
+#include <Instrument/FRA/FRA.h>
+#include <Instrument/Swap/Swap.h>
+#include <DiscountFactorBootstrap/DiscountFactorBootstrap.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Market quote of an instrument used to build the discount factor curve
+// Deposits and swaps start at t0 (startMonths = 0). FRAs start at startMonths and end at endMonths
+struct MarketQuote
+{
+    enum QuoteType { DEPOSIT, FRA, SWAP };
+    QuoteType type;
+    double rate;
+    double startMonths;
+    double endMonths;
+};
+
+// Streaming reader of quote files. The quotes are parsed in place from a fixed size read buffer and the instruments
+// are constructed in buffers sized once in the constructor, so reading does not allocate memory per row.
+// While reading, the instruments are kept sorted by getNumberOfYearsLastPayment (the order the bootstrap needs).
+// Two formats are accepted (one quote per line):
+// - CSV: type,rate,start_months,end_months  e.g.  SWAP,0.055,0,12  (a first line with the column names is skipped)
+// - JSON lines: {"type":"FRA","rate":0.052,"start":6,"end":12}
+template <class T>
+class QuoteReader
+{
+    private:
+        static const int BUFFER_SIZE = 1 << 16;      // Bytes read from the file at once (maximum length of a line)
+        static const int MAX_INSERTION_DISTANCE = 64;  // Maximum number of instruments moved to insert one sorted
+
+        int capacity;                             // Maximum number of instruments
+        std::vector<Deposit<T>> deposits;         // Instrument buffers (never reallocated: capacity reserved)
+        std::vector<FRA<T>> fras;
+        std::vector<Swap<T>> swaps;
+        std::vector<Instrument*> sortedInstruments;
+        bool isSorted;                            // False if some instruments were appended out of order
+        std::vector<char> buffer;                 // Read buffer
+
+        long numQuotes;                           // Quotes accepted
+        long numRejected;                         // Lines that are not valid quotes
+        double elapsedSeconds;                    // Time spent reading and parsing
+
+        typedef bool (QuoteReader<T>::*LineParser)(char* line, MarketQuote& quote);
+        bool readFile(std::string path, LineParser parser);
+        bool parseCsvLine(char* line, MarketQuote& quote);
+        bool parseJsonLine(char* line, MarketQuote& quote);
+        bool parseJsonNumber(const char* line, const char* key, double& value);
+        bool parseType(const char* text, int length, MarketQuote& quote);
+        bool addQuote(const MarketQuote& quote);
+    public:
+        QuoteReader(int _capacity);
+
+        bool readCsv(std::string path);
+        bool readJsonLines(std::string path);
+
+        // Instruments sorted by the date of their last payment
+        std::vector<Instrument*>& getSortedInstruments();
+
+        // Build the discount factor curve with a DiscountFactorBootstrap from the instruments read
+        DiscountFactorCurve bootstrap();
+
+        long getNumberOfQuotes(){ return this->numQuotes;}
+        long getNumberOfRejectedQuotes(){ return this->numRejected;}
+        double getQuotesPerSecond(){ return (this->elapsedSeconds > 0) ? this->numQuotes / this->elapsedSeconds : 0;}
+};
+
+template <class T>
+QuoteReader<T>::QuoteReader(int _capacity)
+{
+    this->capacity = _capacity;
+    this->deposits.reserve(_capacity);
+    this->fras.reserve(_capacity);
+    this->swaps.reserve(_capacity);
+    this->sortedInstruments.reserve(_capacity);
+    this->isSorted = true;
+    this->buffer.resize(BUFFER_SIZE + 1);  // One more byte to terminate the last line
+    this->numQuotes = 0;
+    this->numRejected = 0;
+    this->elapsedSeconds = 0;
+}
+
+template <class T>
+bool QuoteReader<T>::readCsv(std::string path)
+{
+    return this->readFile(path, &QuoteReader<T>::parseCsvLine);
+}
+
+template <class T>
+bool QuoteReader<T>::readJsonLines(std::string path)
+{
+    return this->readFile(path, &QuoteReader<T>::parseJsonLine);
+}
+
+template <class T>
+bool QuoteReader<T>::readFile(std::string path, LineParser parser)
+{
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    char* data = this->buffer.data();
+    size_t pending = 0;          // Bytes of an incomplete line kept from the previous read
+    bool skippingLine = false;   // The rest of a line longer than the buffer is being dropped
+    bool endOfFile = false;
+    while (!endOfFile)
+    {
+        size_t bytesRead = std::fread(data + pending, 1, BUFFER_SIZE - pending, file);
+        endOfFile = (bytesRead < BUFFER_SIZE - pending);
+        size_t available = pending + bytesRead;
+
+        char* lineStart = data;
+        char* end = data + available;
+        char* lineEnd = (char*)std::memchr(lineStart, '\n', end - lineStart);
+        if (skippingLine)
+        {
+            // The tail of the long line is not a quote: resume after its end of line
+            if (lineEnd == nullptr)
+            {
+                pending = 0;
+                continue;
+            }
+            skippingLine = false;
+            lineStart = lineEnd + 1;
+            lineEnd = (char*)std::memchr(lineStart, '\n', end - lineStart);
+        }
+
+        // Parse every complete line in place (the end of line is replaced by '\0')
+        while (lineEnd != nullptr)
+        {
+            *lineEnd = '\0';
+            MarketQuote quote;
+            if ((this->*parser)(lineStart, quote))
+            {
+                this->addQuote(quote);
+            }
+            lineStart = lineEnd + 1;
+            lineEnd = (char*)std::memchr(lineStart, '\n', end - lineStart);
+        }
+
+        pending = end - lineStart;
+        if (endOfFile && pending > 0)
+        {
+            // Last line without end of line
+            data[available] = '\0';
+            MarketQuote quote;
+            if ((this->*parser)(lineStart, quote))
+            {
+                this->addQuote(quote);
+            }
+            pending = 0;
+        }
+        else if (pending == BUFFER_SIZE)
+        {
+            // A line longer than the buffer cannot be a quote: drop it up to its end of line
+            this->numRejected = this->numRejected + 1;
+            skippingLine = true;
+            pending = 0;
+        }
+        else
+        {
+            std::memmove(data, lineStart, pending);
+        }
+    }
+    std::fclose(file);
+
+    this->elapsedSeconds = this->elapsedSeconds +
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+template <class T>
+bool QuoteReader<T>::parseType(const char* text, int length, MarketQuote& quote)
+{
+    if (length == 7 && std::strncmp(text, "DEPOSIT", 7) == 0)
+    {
+        quote.type = MarketQuote::DEPOSIT;
+    }
+    else if (length == 3 && std::strncmp(text, "FRA", 3) == 0)
+    {
+        quote.type = MarketQuote::FRA;
+    }
+    else if (length == 4 && std::strncmp(text, "SWAP", 4) == 0)
+    {
+        quote.type = MarketQuote::SWAP;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+template <class T>
+bool QuoteReader<T>::parseCsvLine(char* line, MarketQuote& quote)
+{
+    // Empty lines, comments and the header are skipped without being counted as rejected quotes
+    if (line[0] == '\0' || line[0] == '\r' || line[0] == '#' || std::strncmp(line, "type", 4) == 0)
+    {
+        return false;
+    }
+
+    char* comma = std::strchr(line, ',');
+    char* end;
+    bool valid = (comma != nullptr) && this->parseType(line, comma - line, quote);
+    if (valid)
+    {
+        quote.rate = std::strtod(comma + 1, &end);
+        valid = (*end == ',');
+    }
+    if (valid)
+    {
+        quote.startMonths = std::strtod(end + 1, &end);
+        valid = (*end == ',');
+    }
+    if (valid)
+    {
+        quote.endMonths = std::strtod(end + 1, &end);
+        valid = (*end == '\0' || *end == '\r');
+    }
+    if (!valid)
+    {
+        this->numRejected = this->numRejected + 1;
+    }
+    return valid;
+}
+
+template <class T>
+bool QuoteReader<T>::parseJsonNumber(const char* line, const char* key, double& value)
+{
+    // Flat objects only: find the key and read the number after the colon (strtod skips the blanks)
+    const char* position = std::strstr(line, key);
+    position = (position != nullptr) ? std::strchr(position + std::strlen(key), ':') : nullptr;
+    if (position == nullptr)
+    {
+        return false;
+    }
+    char* numberEnd;
+    value = std::strtod(position + 1, &numberEnd);
+    return numberEnd != position + 1;
+}
+
+template <class T>
+bool QuoteReader<T>::parseJsonLine(char* line, MarketQuote& quote)
+{
+    if (line[0] == '\0' || line[0] == '\r')
+    {
+        return false;
+    }
+
+    const char* type = std::strstr(line, "\"type\"");
+    const char* typeBegin = (type != nullptr) ? std::strchr(type + 6, ':') : nullptr;
+    typeBegin = (typeBegin != nullptr) ? std::strchr(typeBegin, '"') : nullptr;
+    const char* typeEnd = (typeBegin != nullptr) ? std::strchr(typeBegin + 1, '"') : nullptr;
+
+    bool valid = (typeEnd != nullptr) && this->parseType(typeBegin + 1, typeEnd - typeBegin - 1, quote) &&
+                 this->parseJsonNumber(line, "\"rate\"", quote.rate) &&
+                 this->parseJsonNumber(line, "\"start\"", quote.startMonths) &&
+                 this->parseJsonNumber(line, "\"end\"", quote.endMonths);
+    if (!valid)
+    {
+        this->numRejected = this->numRejected + 1;
+    }
+    return valid;
+}
+
+template <class T>
+bool QuoteReader<T>::addQuote(const MarketQuote& quote)
+{
+    // Validate the quote: finite rate, positive length and spot starting deposits and swaps
+    bool valid = std::isfinite(quote.rate) && std::abs(quote.rate) < 1 &&
+                 quote.startMonths >= 0 && quote.endMonths > quote.startMonths &&
+                 (quote.type == MarketQuote::FRA || quote.startMonths == 0) &&
+                 this->sortedInstruments.size() < this->capacity;
+    if (!valid)
+    {
+        this->numRejected = this->numRejected + 1;
+        return false;
+    }
+
+    // Construct the instrument in its buffer (the capacity was reserved, so the addresses do not change)
+    Instrument* instrument;
+    if (quote.type == MarketQuote::DEPOSIT)
+    {
+        this->deposits.push_back(Deposit<T>(quote.rate, quote.endMonths));
+        instrument = &this->deposits.back();
+    }
+    else if (quote.type == MarketQuote::FRA)
+    {
+        this->fras.push_back(FRA<T>(quote.rate, quote.startMonths, quote.endMonths));
+        instrument = &this->fras.back();
+    }
+    else
+    {
+        this->swaps.push_back(Swap<T>(quote.rate, quote.endMonths));
+        instrument = &this->swaps.back();
+    }
+
+    // Insert it after the instruments that end before or at the same time. Quote files are usually sorted or nearly
+    // sorted, so the insertion is at the end or moves a few pointers. If it would move many, the instrument is
+    // appended and the whole vector is sorted once when it is requested
+    std::vector<Instrument*>::iterator position = std::upper_bound(this->sortedInstruments.begin(),
+            this->sortedInstruments.end(), instrument, compareEndPeriods);
+    if (this->isSorted && this->sortedInstruments.end() - position <= MAX_INSERTION_DISTANCE)
+    {
+        this->sortedInstruments.insert(position, instrument);
+    }
+    else
+    {
+        this->sortedInstruments.push_back(instrument);
+        this->isSorted = false;
+    }
+    this->numQuotes = this->numQuotes + 1;
+    return true;
+}
+
+template <class T>
+std::vector<Instrument*>& QuoteReader<T>::getSortedInstruments()
+{
+    if (!this->isSorted)
+    {
+        std::stable_sort(this->sortedInstruments.begin(), this->sortedInstruments.end(), compareEndPeriods);
+        this->isSorted = true;
+    }
+    return this->sortedInstruments;
+}
+
+template <class T>
+DiscountFactorCurve QuoteReader<T>::bootstrap()
+{
+    DiscountFactorBootstrap discountFactorBootstrap;
+    return discountFactorBootstrap.bootstrap(this->getSortedInstruments());
+}
+
+#endif //SQF_QUOTEREADER_H
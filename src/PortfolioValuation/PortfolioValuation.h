@@ -0,0 +1,136 @@
+#ifndef SQF_PORTFOLIOVALUATION_H
+#define SQF_PORTFOLIOVALUATION_H
+
+#include <ThreadPool/ThreadPool.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Sum of n values with a fixed tree: halves summed recursively, and runs of up to 8 values summed in order. The order
+// of the additions only depends on n, so the result is the same bits whoever computed the values
+double pairwiseSum(const double* values, int n)
+{
+    if (n <= 8)
+    {
+        double sum = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            sum = sum + values[i];
+        }
+        return sum;
+    }
+    int half = n / 2;
+    return pairwiseSum(values, half) + pairwiseSum(values + half, n - half);
+}
+
+// Present value of a portfolio of trades (Swap, Bond... or any function that values a trade) on a ThreadPool.
+// The trades are split in ranges: a task halves its range, submits the second half and goes on with the first until
+// it has at most grainSize trades, which it values. The halves wait at the back of the queue of the worker, so the
+// idle workers steal the largest ranges left (from the front) and the cheap trades (2 cashflows) and the expensive
+// ones (200 cashflows) are balanced without knowing their cost.
+// The present value of each trade is written to its position in the results, and the totals are pairwise sums of the
+// results in the order of the trades, so they do not depend on the number of threads nor on who valued each trade.
+// The trades are not owned. A trade is valued by a single task, but the curves are shared: they must not change
+// during a valuation
+class PortfolioValuation
+{
+    public:
+        typedef std::function<double()> TradeValuation;
+
+    private:
+        std::vector<TradeValuation> trades;
+        std::vector<double> presentValues;
+        int grainSize;                        // Maximum number of trades valued by a task without splitting
+
+        std::mutex doneMutex;
+        std::condition_variable allDone;
+        int numValued;
+
+        void valueRange(ThreadPool& pool, int first, int last);
+        void finishRange(int numTrades);
+    public:
+        PortfolioValuation(int _grainSize = 16);
+
+        // Returns the id of the trade (its position in the results)
+        int addTrade(TradeValuation valuation);
+        template <class V>
+        int addTrade(V* trade){ return this->addTrade([trade](){ return trade->computePresentValue();});}
+
+        // Value every trade on the pool (or in this thread) and wait for all of them
+        void run(ThreadPool& pool);
+        void run();
+
+        const std::vector<double>& getPresentValues(){ return this->presentValues;}
+        double getPresentValue(int trade){ return this->presentValues[trade];}
+        double getTotalPresentValue(){ return pairwiseSum(this->presentValues.data(), this->presentValues.size());}
+        // Total of the trades [first, last), with the same fixed order
+        double getTotalPresentValue(int first, int last){ return pairwiseSum(this->presentValues.data() + first, last - first);}
+        int getNumberOfTrades(){ return this->trades.size();}
+};
+
+PortfolioValuation::PortfolioValuation(int _grainSize)
+{
+    this->grainSize = (_grainSize > 0) ? _grainSize : 1;
+    this->numValued = 0;
+}
+
+int PortfolioValuation::addTrade(TradeValuation valuation)
+{
+    this->trades.push_back(valuation);
+    return this->trades.size() - 1;
+}
+
+void PortfolioValuation::run(ThreadPool& pool)
+{
+    this->presentValues.assign(this->trades.size(), 0);
+    this->numValued = 0;
+    if (this->trades.empty())
+    {
+        return;
+    }
+
+    int numTrades = this->trades.size();
+    pool.submit([this, &pool, numTrades](){ this->valueRange(pool, 0, numTrades);});
+
+    std::unique_lock<std::mutex> lock(this->doneMutex);
+    this->allDone.wait(lock, [this](){ return this->numValued == this->trades.size();});
+}
+
+void PortfolioValuation::run()
+{
+    this->presentValues.assign(this->trades.size(), 0);
+    for (int i = 0; i < this->trades.size(); ++i)
+    {
+        this->presentValues[i] = this->trades[i]();
+    }
+    this->numValued = this->trades.size();
+}
+
+void PortfolioValuation::valueRange(ThreadPool& pool, int first, int last)
+{
+    while (last - first > this->grainSize)
+    {
+        int middle = first + (last - first) / 2;
+        pool.submit([this, &pool, middle, last](){ this->valueRange(pool, middle, last);});
+        last = middle;
+    }
+    for (int i = first; i < last; ++i)
+    {
+        this->presentValues[i] = this->trades[i]();
+    }
+    this->finishRange(last - first);
+}
+
+void PortfolioValuation::finishRange(int numTrades)
+{
+    // The mutex also publishes the present values written by this task to the thread waiting in run
+    std::lock_guard<std::mutex> lock(this->doneMutex);
+    this->numValued = this->numValued + numTrades;
+    if (this->numValued == this->trades.size())
+    {
+        this->allDone.notify_all();
+    }
+}
+
+#endif //SQF_PORTFOLIOVALUATION_H
@@ -33,11 +33,10 @@
 #include <algorithm>
 
 
-// unnamed namespace only because the implementation is in this
-// header file and we don't want to export symbols to the obj files
-namespace
-{
-
+// The implementation is in this header file: the functions defined
+// outside the classes are inline, so every obj file can include it.
+// (tk is not in an unnamed namespace, as curves that keep a spline
+// as a member are used from several headers)
     namespace tk
     {
 
@@ -124,11 +123,11 @@ namespace
 // band_matrix implementation
 // -------------------------
 
-        band_matrix::band_matrix(int dim, int n_u, int n_l)
+        inline band_matrix::band_matrix(int dim, int n_u, int n_l)
         {
             resize(dim, n_u, n_l);
         }
-        void band_matrix::resize(int dim, int n_u, int n_l)
+        inline void band_matrix::resize(int dim, int n_u, int n_l)
         {
             assert(dim>0);
             assert(n_u>=0);
@@ -142,7 +141,7 @@ namespace
                 m_lower[i].resize(dim);
             }
         }
-        int band_matrix::dim() const
+        inline int band_matrix::dim() const
         {
             if(m_upper.size()>0) {
                 return m_upper[0].size();
@@ -154,7 +153,7 @@ namespace
 
 // defines the new operator (), so that we can access the elements
 // by A(i,j), index going from i=0,...,dim()-1
-        double & band_matrix::operator () (int i, int j)
+        inline double & band_matrix::operator () (int i, int j)
         {
             int k=j-i;       // what band is the entry
             assert( (i>=0) && (i<dim()) && (j>=0) && (j<dim()) );
@@ -163,7 +162,7 @@ namespace
             if(k>=0)   return m_upper[k][i];
             else	    return m_lower[-k][i];
         }
-        double band_matrix::operator () (int i, int j) const
+        inline double band_matrix::operator () (int i, int j) const
         {
             int k=j-i;       // what band is the entry
             assert( (i>=0) && (i<dim()) && (j>=0) && (j<dim()) );
@@ -173,19 +172,19 @@ namespace
             else	    return m_lower[-k][i];
         }
 // second diag (used in LU decomposition), saved in m_lower
-        double band_matrix::saved_diag(int i) const
+        inline double band_matrix::saved_diag(int i) const
         {
             assert( (i>=0) && (i<dim()) );
             return m_lower[0][i];
         }
-        double & band_matrix::saved_diag(int i)
+        inline double & band_matrix::saved_diag(int i)
         {
             assert( (i>=0) && (i<dim()) );
             return m_lower[0][i];
         }
 
 // LR-Decomposition of a band matrix
-        void band_matrix::lu_decompose()
+        inline void band_matrix::lu_decompose()
         {
             int  i_max,j_max;
             int  j_min;
@@ -220,7 +219,7 @@ namespace
             }
         }
 // solves Ly=b
-        std::vector<double> band_matrix::l_solve(const std::vector<double>& b) const
+        inline std::vector<double> band_matrix::l_solve(const std::vector<double>& b) const
         {
             assert( this->dim()==(int)b.size() );
             std::vector<double> x(this->dim());
@@ -235,7 +234,7 @@ namespace
             return x;
         }
 // solves Rx=y
-        std::vector<double> band_matrix::r_solve(const std::vector<double>& b) const
+        inline std::vector<double> band_matrix::r_solve(const std::vector<double>& b) const
         {
             assert( this->dim()==(int)b.size() );
             std::vector<double> x(this->dim());
@@ -250,7 +249,7 @@ namespace
             return x;
         }
 
-        std::vector<double> band_matrix::lu_solve(const std::vector<double>& b,
+        inline std::vector<double> band_matrix::lu_solve(const std::vector<double>& b,
                                                   bool is_lu_decomposed)
         {
             assert( this->dim()==(int)b.size() );
@@ -269,7 +268,7 @@ namespace
 // spline implementation
 // -----------------------
 
-        void spline::set_boundary(spline::bd_type left, double left_value,
+        inline void spline::set_boundary(spline::bd_type left, double left_value,
                                   spline::bd_type right, double right_value,
                                   bool force_linear_extrapolation)
         {
@@ -282,7 +281,7 @@ namespace
         }
 
 
-        void spline::set_points(const std::vector<double>& x,
+        inline void spline::set_points(const std::vector<double>& x,
                                 const std::vector<double>& y, bool cubic_spline)
         {
             assert(x.size()==y.size());
@@ -373,7 +372,7 @@ namespace
                 m_b[n-1]=0.0;
         }
 
-        double spline::operator() (double x) const
+        inline double spline::operator() (double x) const
         {
             size_t n=m_x.size();
             // find the closest point m_x[idx] < x, idx=0 even if x<m_x[0]
@@ -396,7 +395,7 @@ namespace
             return interpol;
         }
 
-        double spline::deriv(int order, double x) const
+        inline double spline::deriv(int order, double x) const
         {
             assert(order>0);
 
@@ -458,7 +457,4 @@ namespace
 
     } // namespace tk
 
-
-} // namespace
-
 #endif /* TK_SPLINE_H */
\ No newline at end of file
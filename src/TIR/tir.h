@@ -4,6 +4,7 @@
 //#include <zeroCuponInterestRate/zeroCuponCurve/zeroCouponCurve.h>
 #include <cmath>
 #include "CouponPayments.h"
+#include <Compounding/Compounding.h>
 #include <vector>
 
 
@@ -44,7 +45,7 @@ double tir::presentValueMinusMarketValue(double interest)
     double ret = 0;
     for(int i = 0; i<payment.size(); i++)
     {
-        ret = ret + payment[i].couponAmount * exp(-interest * payment[i].dateInYears);
+        ret = ret + payment[i].couponAmount * ContinuousCompounding::discountFactor(interest, payment[i].dateInYears);
     }
     ret = ret - marketValue;
     return ret;
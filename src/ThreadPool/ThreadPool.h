@@ -0,0 +1,172 @@
+#ifndef SQF_THREADPOOL_H
+#define SQF_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Each worker owns a queue of tasks:
+// - A task submitted from a worker goes to the back of its own queue, and the worker takes its tasks from the back
+//   (the last task submitted is the one with its data still in cache)
+// - A task submitted from outside the pool is distributed round robin among the queues
+// - A worker with an empty queue steals from the front of the queues of the others (the oldest tasks)
+// The workers sleep while there are no tasks. The destructor waits for the tasks already submitted
+class ThreadPool
+{
+    public:
+        typedef std::function<void()> Task;
+
+    private:
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::thread> workers;
+        std::vector<std::unique_ptr<WorkerQueue>> queues;  // One queue per worker
+        std::mutex sleepMutex;                             // Protects pendingTasks and stopping for the sleeping workers
+        std::condition_variable wakeUp;
+        int pendingTasks;                                  // Tasks submitted and not taken yet
+        bool stopping;
+        std::atomic<unsigned int> nextQueue;               // Queue of the next task submitted from outside the pool
+        std::atomic<long> numStolenTasks;
+
+        static int& currentWorker();                       // Index of the worker running in this thread (-1 if none)
+        static ThreadPool*& currentPool();                 // Pool of that worker
+
+        void work(int index);
+        bool takeLocal(int index, Task& task);
+        bool steal(int index, Task& task);
+        void taken();
+    public:
+        ThreadPool(int numThreads = std::thread::hardware_concurrency());
+        ~ThreadPool();
+
+        void submit(Task task);
+
+        int getNumberOfThreads(){ return this->workers.size();}
+        long getNumberOfStolenTasks(){ return this->numStolenTasks.load();}
+};
+
+int& ThreadPool::currentWorker()
+{
+    static thread_local int index = -1;
+    return index;
+}
+
+ThreadPool*& ThreadPool::currentPool()
+{
+    static thread_local ThreadPool* pool = nullptr;
+    return pool;
+}
+
+ThreadPool::ThreadPool(int numThreads)
+{
+    numThreads = (numThreads > 0) ? numThreads : 1;
+    this->pendingTasks = 0;
+    this->stopping = false;
+    this->nextQueue = 0;
+    this->numStolenTasks = 0;
+    for (int i = 0; i < numThreads; ++i)
+    {
+        this->queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    for (int i = 0; i < numThreads; ++i)
+    {
+        this->workers.push_back(std::thread(&ThreadPool::work, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->sleepMutex);
+        this->stopping = true;
+    }
+    this->wakeUp.notify_all();
+    for (int i = 0; i < this->workers.size(); ++i)
+    {
+        this->workers[i].join();
+    }
+}
+
+void ThreadPool::submit(Task task)
+{
+    int index = (currentPool() == this) ? currentWorker() : this->nextQueue.fetch_add(1) % this->queues.size();
+    {
+        std::lock_guard<std::mutex> lock(this->queues[index]->mutex);
+        this->queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->sleepMutex);
+        this->pendingTasks = this->pendingTasks + 1;
+    }
+    this->wakeUp.notify_one();
+}
+
+void ThreadPool::taken()
+{
+    std::lock_guard<std::mutex> lock(this->sleepMutex);
+    this->pendingTasks = this->pendingTasks - 1;
+}
+
+bool ThreadPool::takeLocal(int index, Task& task)
+{
+    std::lock_guard<std::mutex> lock(this->queues[index]->mutex);
+    if (this->queues[index]->tasks.empty())
+    {
+        return false;
+    }
+    task = std::move(this->queues[index]->tasks.back());
+    this->queues[index]->tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(int index, Task& task)
+{
+    for (int i = 1; i < this->queues.size(); ++i)
+    {
+        WorkerQueue& victim = *this->queues[(index + i) % this->queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            this->numStolenTasks.fetch_add(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::work(int index)
+{
+    currentWorker() = index;
+    currentPool() = this;
+    while (true)
+    {
+        Task task;
+        if (this->takeLocal(index, task) || this->steal(index, task))
+        {
+            this->taken();
+            task();
+            continue;
+        }
+
+        // Nothing to do: sleep until a task is submitted (or the pool is destroyed and every task has been taken)
+        std::unique_lock<std::mutex> lock(this->sleepMutex);
+        this->wakeUp.wait(lock, [this](){ return this->stopping || this->pendingTasks > 0;});
+        if (this->stopping && this->pendingTasks == 0)
+        {
+            return;
+        }
+    }
+}
+
+#endif //SQF_THREADPOOL_H
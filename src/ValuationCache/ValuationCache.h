@@ -0,0 +1,222 @@
+#ifndef SQF_VALUATIONCACHE_H
+#define SQF_VALUATIONCACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// Cache of the last valuation of each trade, so a trade is valued again only if the trade or one of its curves changed.
+// A valuation is stored with the version of the trade and the versions of the curves it was computed with
+// (ZeroCouponYieldCurve::getVersion, DiscountFactorCurve::getVersion after a bootstrap...). The curve versions are
+// drawn from one counter (nextCurveVersion), so two different curves never have the same version and the curves can
+// be passed in any order as long as it is the same for a trade. It is a hit only if all the versions are the same;
+// otherwise the stale valuation is dropped (a curve bump invalidates the trades that use it the next time they are
+// asked for, without tracking which trades depend on which curves).
+// The memory is bounded: when the valuations take more than maxBytes the least recently used ones are evicted.
+// The cache is not thread safe: it is read and filled by the thread that serves the valuation requests
+class ValuationCache
+{
+    public:
+        typedef std::function<double()> TradeValuation;
+        typedef std::function<double(std::vector<double>&)> TradeRiskValuation;  // Present value and risk
+
+    private:
+        struct Entry
+        {
+            int tradeId;
+            unsigned long tradeVersion;
+            std::vector<unsigned long> curveVersions;
+            double presentValue;
+            std::vector<double> risk;  // Empty if the valuation was stored without risk
+            bool hasRisk;
+        };
+
+        std::list<Entry> entries;                                   // From the most to the least recently used
+        std::unordered_map<int, std::list<Entry>::iterator> entryOf;  // Entry of each trade id
+        std::size_t maxBytes;
+        std::size_t usedBytes;
+
+        long numHits;
+        long numMisses;
+        long numInvalidations;  // Misses because the trade or a curve changed since the valuation was stored
+        long numEvictions;
+
+        static std::size_t getBytes(const Entry& entry);
+        Entry* lookUp(int tradeId, unsigned long tradeVersion, const std::vector<unsigned long>& curveVersions, bool needRisk);
+        void evict();
+    public:
+        ValuationCache(std::size_t _maxBytes = 64 << 20);
+
+        // Stored valuation of the trade with these versions. Returns false (a miss) if there is none
+        bool find(int tradeId, unsigned long tradeVersion, const std::vector<unsigned long>& curveVersions,
+                  double& presentValue, std::vector<double>* risk = nullptr);
+        // Store a valuation (replacing the one of the trade, if any)
+        void insert(int tradeId, unsigned long tradeVersion, const std::vector<unsigned long>& curveVersions,
+                    double presentValue, const std::vector<double>* risk = nullptr);
+
+        // Stored valuation, or the one computed (and stored) by valuation on a miss
+        double getPresentValue(int tradeId, unsigned long tradeVersion, const std::vector<unsigned long>& curveVersions,
+                               TradeValuation valuation);
+        double getPresentValue(int tradeId, unsigned long tradeVersion, const std::vector<unsigned long>& curveVersions,
+                               TradeRiskValuation valuation, std::vector<double>& risk);
+
+        void erase(int tradeId);  // Trade removed from the book
+        void clear();
+
+        // Metrics (since the cache was built or the metrics reset)
+        long getNumberOfHits(){ return this->numHits;}
+        long getNumberOfMisses(){ return this->numMisses;}
+        long getNumberOfInvalidations(){ return this->numInvalidations;}
+        long getNumberOfEvictions(){ return this->numEvictions;}
+        double getHitRate(){ return (this->numHits + this->numMisses > 0) ? (double)this->numHits / (this->numHits + this->numMisses) : 0;}
+        void resetMetrics();
+        int getNumberOfEntries(){ return this->entries.size();}
+        std::size_t getMemoryBytes(){ return this->usedBytes;}
+};
+
+ValuationCache::ValuationCache(std::size_t _maxBytes)
+{
+    this->maxBytes = _maxBytes;
+    this->usedBytes = 0;
+    this->resetMetrics();
+}
+
+std::size_t ValuationCache::getBytes(const Entry& entry)
+{
+    // The entry, its vectors, and the list and map nodes (about 4 pointers)
+    return sizeof(Entry) + 4 * sizeof(void*) + entry.curveVersions.capacity() * sizeof(unsigned long) +
+           entry.risk.capacity() * sizeof(double);
+}
+
+ValuationCache::Entry* ValuationCache::lookUp(int tradeId, unsigned long tradeVersion,
+                                              const std::vector<unsigned long>& curveVersions, bool needRisk)
+{
+    std::unordered_map<int, std::list<Entry>::iterator>::iterator found = this->entryOf.find(tradeId);
+    if (found == this->entryOf.end())
+    {
+        this->numMisses = this->numMisses + 1;
+        return nullptr;
+    }
+    Entry& entry = *found->second;
+    if (entry.tradeVersion != tradeVersion || entry.curveVersions != curveVersions)
+    {
+        // Stale: it will never be a hit again
+        this->numMisses = this->numMisses + 1;
+        this->numInvalidations = this->numInvalidations + 1;
+        this->erase(tradeId);
+        return nullptr;
+    }
+    if (needRisk && !entry.hasRisk)
+    {
+        this->numMisses = this->numMisses + 1;
+        return nullptr;
+    }
+
+    // Most recently used: move it to the front of the list (the iterators stay valid)
+    this->entries.splice(this->entries.begin(), this->entries, found->second);
+    this->numHits = this->numHits + 1;
+    return &entry;
+}
+
+bool ValuationCache::find(int tradeId, unsigned long tradeVersion, const std::vector<unsigned long>& curveVersions,
+                          double& presentValue, std::vector<double>* risk)
+{
+    Entry* entry = this->lookUp(tradeId, tradeVersion, curveVersions, risk != nullptr);
+    if (entry == nullptr)
+    {
+        return false;
+    }
+    presentValue = entry->presentValue;
+    if (risk != nullptr)
+    {
+        *risk = entry->risk;
+    }
+    return true;
+}
+
+void ValuationCache::insert(int tradeId, unsigned long tradeVersion, const std::vector<unsigned long>& curveVersions,
+                            double presentValue, const std::vector<double>* risk)
+{
+    this->erase(tradeId);
+
+    Entry entry;
+    entry.tradeId = tradeId;
+    entry.tradeVersion = tradeVersion;
+    entry.curveVersions = curveVersions;
+    entry.presentValue = presentValue;
+    entry.hasRisk = (risk != nullptr);
+    if (risk != nullptr)
+    {
+        entry.risk = *risk;
+    }
+    this->usedBytes = this->usedBytes + getBytes(entry);
+    this->entries.push_front(std::move(entry));
+    this->entryOf[tradeId] = this->entries.begin();
+    this->evict();
+}
+
+void ValuationCache::evict()
+{
+    // Least recently used first. The entry just inserted is kept even if it alone is larger than maxBytes
+    while (this->usedBytes > this->maxBytes && this->entries.size() > 1)
+    {
+        this->erase(this->entries.back().tradeId);
+        this->numEvictions = this->numEvictions + 1;
+    }
+}
+
+double ValuationCache::getPresentValue(int tradeId, unsigned long tradeVersion,
+                                       const std::vector<unsigned long>& curveVersions, TradeValuation valuation)
+{
+    double presentValue;
+    if (!this->find(tradeId, tradeVersion, curveVersions, presentValue))
+    {
+        presentValue = valuation();
+        this->insert(tradeId, tradeVersion, curveVersions, presentValue);
+    }
+    return presentValue;
+}
+
+double ValuationCache::getPresentValue(int tradeId, unsigned long tradeVersion,
+                                       const std::vector<unsigned long>& curveVersions, TradeRiskValuation valuation,
+                                       std::vector<double>& risk)
+{
+    double presentValue;
+    if (!this->find(tradeId, tradeVersion, curveVersions, presentValue, &risk))
+    {
+        risk.clear();
+        presentValue = valuation(risk);
+        this->insert(tradeId, tradeVersion, curveVersions, presentValue, &risk);
+    }
+    return presentValue;
+}
+
+void ValuationCache::erase(int tradeId)
+{
+    std::unordered_map<int, std::list<Entry>::iterator>::iterator found = this->entryOf.find(tradeId);
+    if (found != this->entryOf.end())
+    {
+        this->usedBytes = this->usedBytes - getBytes(*found->second);
+        this->entries.erase(found->second);
+        this->entryOf.erase(found);
+    }
+}
+
+void ValuationCache::clear()
+{
+    this->entries.clear();
+    this->entryOf.clear();
+    this->usedBytes = 0;
+}
+
+void ValuationCache::resetMetrics()
+{
+    this->numHits = 0;
+    this->numMisses = 0;
+    this->numInvalidations = 0;
+    this->numEvictions = 0;
+}
+
+#endif //SQF_VALUATIONCACHE_H
@@ -3,8 +3,10 @@
 
 #include <ctime>
 #include <cmath>
+#include <Compounding/Compounding.h>
 
-template <class T>
+// T: day count convention, C: compounding of the zero coupon rate
+template <class T, class C = ContinuousCompounding>
 class ZeroCoupon
 {
     private:
@@ -18,30 +20,34 @@ class ZeroCoupon
         // Setter: Called in ZeroCouponYieldCurve to set the forward of the ith zeroCoupon object
         // in the zeroCouponVector
         void setForward(double timeInYearsBefore, double interestRateBefore, double numOfPeriodsPerYear, int actualPeriod);
+        void setInterestRate(double _zeroCouponInterestRate){ this->zeroCouponInterestRate = _zeroCouponInterestRate;}
 
         // Getters:
-        double getTime(){return this->timeInYears;}   // Time in years between initial date and the date it is provided
-        double getForward() { return this->forward;}  // Computed in setForward
+        double getTime() const {return this->timeInYears;}   // Time in years between initial date and the date it is provided
+        double getForward() const { return this->forward;}  // Computed in setForward
         // Coupon interest rate (percentage of the nominal that the coupon pays). Variable for floating leg
-        double getInterestRate() { return this->zeroCouponInterestRate;}
+        double getInterestRate() const { return this->zeroCouponInterestRate;}
 
 };
 
-template <class T>
-ZeroCoupon<T>::ZeroCoupon(std::tm _date, double _zeroCouponInterestRate, T dayConventionObject, std::tm initialDate)
+template <class T, class C>
+ZeroCoupon<T, C>::ZeroCoupon(std::tm _date, double _zeroCouponInterestRate, T dayConventionObject, std::tm initialDate)
 {
     this-> date = _date;
     this->zeroCouponInterestRate = _zeroCouponInterestRate;
     this->timeInYears = dayConventionObject.compute_daycount(initialDate, _date) / 360;  // dayConventionObject is a Date object (Actual_360 or Thirty_360)
 }
 
-template <class T>
-void ZeroCoupon<T>::setForward(double timeInYearsBefore, double interestRateBefore, double numOfPeriodsPerYear, int actualPeriod)
+template <class T, class C>
+void ZeroCoupon<T, C>::setForward(double timeInYearsBefore, double interestRateBefore, double numOfPeriodsPerYear, int actualPeriod)
 {
     // Forward interest rate between last and current period for a given fractional period
-    // It is not divided over the difference between last and current period because this difference is 1
-    double RF = (this->zeroCouponInterestRate*actualPeriod - interestRateBefore*(actualPeriod-1));
-    this->forward = numOfPeriodsPerYear * (exp(RF/numOfPeriodsPerYear) - 1);  // Transform to fractional periods
+    // The periods are measured in fractional periods: the last one ends at (actualPeriod-1)/numOfPeriodsPerYear
+    // and the current one at actualPeriod/numOfPeriodsPerYear years
+    double growth = C::forwardGrowthFactor(interestRateBefore, (actualPeriod-1) / numOfPeriodsPerYear,
+                                           this->zeroCouponInterestRate, actualPeriod / numOfPeriodsPerYear);
+    // The forward compounded once per fractional period is the simple rate over that period
+    this->forward = SimpleCompounding::rateFromGrowthFactor(growth, 1 / numOfPeriodsPerYear);
 }
 
 #endif //SQF_ZEROCOUPON_H
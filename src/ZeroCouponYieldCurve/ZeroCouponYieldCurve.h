@@ -3,10 +3,12 @@
 
 #include <Spline/spline.h>
 #include <ZeroCoupon/ZeroCoupon.h>
+#include <CurveVersion/CurveVersion.h>
 #include <string>
 using namespace std;
 
-template <class T>
+// T: day count convention, C: compounding of the zero coupon rates (continuous by default)
+template <class T, class C = ContinuousCompounding>
 class ZeroCouponYieldCurve
 {
     private:
@@ -14,155 +16,224 @@ class ZeroCouponYieldCurve
         std::tm initialDate;         // Date where the curve starts (matches valuation date)
         double numOfPeriodsPerYear;  // Define fractional payments (num payments in a year)
         tk::spline spline;           // Interpolate method to extract zeroCoupon rates from not defined periods
-        std::vector<ZeroCoupon<T>> zeroCouponVector;  // Vector of zeroCoupon objects (each zeroCoupon is associated to a date)
+        std::vector<ZeroCoupon<T, C>> zeroCouponVector;  // Vector of zeroCoupon objects (each zeroCoupon is associated to a date)
+        unsigned long version;       // New every time the curve changes, so dependents know to refresh (nextCurveVersion)
+        std::vector<double> pillarTimes;  // Knots of the spline: maturities in years of the zero coupon rates
+        std::vector<double> pillarRates;  // Values of the spline: zero coupon rates for each maturity
+
+        void computeForward(int i);  // Set the forward of the ith zeroCoupon from the rates at i-1 and i
     public:
+        typedef C Compounding;
+
         ZeroCouponYieldCurve();
         ZeroCouponYieldCurve (T dayConventionObject, std::tm _initialDate); // dayConvention: Actual_360 or Thirty_360
         
         void addZeroCouponRate(std::tm _date, double _zeroCouponInterestRate);
         void computeZeroCurve();                    // Build the zero coupon yield curve
-        double getInterpolatedZCRate(double years); // Get zero coupon rate using interpolation method and the curve
-        double getDiscountFactor(int i);
+        // Change the ith rate and refresh only what depends on it. Returns false (the curve is not changed) if there
+        // is no ith rate or the curve has not been computed
+        bool updateRate(int i, double newRate);
+        double getInterpolatedZCRate(double years) const; // Get zero coupon rate using interpolation method and the curve
+        double getDiscountFactor(int i) const;
 
-        double getForward(int i);  // Get forwards between the periods used to build the curve
-        double getForward(std::tm _firstPeriodDate, std::tm _lastPeriodDate);  // Get forwards between 2 dates
+        double getForward(int i) const;  // Get forwards between the periods used to build the curve
+        double getForward(std::tm _firstPeriodDate, std::tm _lastPeriodDate) const;  // Get forwards between 2 dates
+        double getForward(double _firstDate, double _lastDate) const;  // Same, given the dates in years (no day count)
 
         void setNumOfPeriodsPerYear(double i);
 
         // Get information about dates
-        std::tm getPresentValue();
-        T getDayCountConvention();
-        double getNumOfPeriodsPerYear();
-        double getTimeInYearsFromPresentDate(std::tm _time);
+        std::tm getPresentValue() const;
+        T getDayCountConvention() const;
+        double getNumOfPeriodsPerYear() const;
+        double getTimeInYearsFromPresentDate(std::tm _time) const;
+
+        // Get information about the built curve
+        unsigned long getVersion() const { return this->version;}
+        int getNumberOfRates() const { return this->zeroCouponVector.size();}
+        double getTime(int i) const { return this->zeroCouponVector[i].getTime();}  // Time in years of the ith rate
+        const tk::spline& getSpline() const { return this->spline;}
 };
 
-template <class T>
-ZeroCouponYieldCurve<T>::ZeroCouponYieldCurve() {}
+template <class T, class C>
+ZeroCouponYieldCurve<T, C>::ZeroCouponYieldCurve()
+{
+    this->version = 0;
+}
 
-template <class T>
-ZeroCouponYieldCurve<T>::ZeroCouponYieldCurve (T dayConventionObject, std::tm _initialDate)
+template <class T, class C>
+ZeroCouponYieldCurve<T, C>::ZeroCouponYieldCurve (T dayConventionObject, std::tm _initialDate)
 {
     this->dayCountConvention = dayConventionObject;
     this->initialDate = _initialDate;
+    this->version = 0;
 }
 
-template <class T>
-void ZeroCouponYieldCurve<T>::addZeroCouponRate(std::tm _date, double _zeroCouponInterestRate)
+template <class T, class C>
+void ZeroCouponYieldCurve<T, C>::addZeroCouponRate(std::tm _date, double _zeroCouponInterestRate)
 {
     // Add zero coupon object to the vector
     // Each zeroCoupon object has a _zeroCouponInterestRate associated to a _date (internal attributes)
-    this->zeroCouponVector.push_back(ZeroCoupon<T>( _date,  _zeroCouponInterestRate,
+    this->zeroCouponVector.push_back(ZeroCoupon<T, C>( _date,  _zeroCouponInterestRate,
                                         this->dayCountConvention, this->initialDate ));
 }
 
-template <class T>
-void ZeroCouponYieldCurve<T>::computeZeroCurve()
+template <class T, class C>
+void ZeroCouponYieldCurve<T, C>::computeZeroCurve()
 {
     // Create a zero coupon curve to interpolate the rates that are not in the tables (Rate vs Maturity in years)
-    std::vector<double> time;            // Vector of maturities in years
-    std::vector<double> zeroCouponRate;  // Vector of zero coupon rates for different maturities
-
     // zeroCouponVector[i].getTime(): difference of time in years between this->initial_date and _date
     // zeroCouponVector[1].getTime() - zeroCouponVector[0].getTime() = _date[1] - _date[0] (in years)
     // The inverse of two consecutive date payments is the number of periods a year is divided in
     this->numOfPeriodsPerYear = (double)round(1/(this->zeroCouponVector[1].getTime() - this->zeroCouponVector[0].getTime()));
 
+    this->pillarTimes.clear();
+    this->pillarRates.clear();
     for(int i = 0; i<this->zeroCouponVector.size(); ++i)
     {
-        if(i == 0)
-        {
-            // First element of the rate vector (Forward rate from start period (i=0) to following one (i+1))
-            // zeroCouponVector[i].getTime(): diff in years from initial_period to _date[i]
-            this->zeroCouponVector[i].setForward( 0, 0, this->numOfPeriodsPerYear, i+1);
-            time.push_back(this->zeroCouponVector[i].getTime());
-            zeroCouponRate.push_back(this->zeroCouponVector[i].getInterestRate());
-        }
-        else
-        {
-            // Elements of forward rate vector but 1st one (forward rate between two consecutive dates)
-            // zeroCouponVector[i-1].getTime(): diff in years from initial_period to _date[i-1] (_date[i-1] end of the (i-1) period and start of the following one (i))
-            // zeroCouponVector[i-1].getInterestRate(): interest rate from the previous period (period from i-1 to i)
-            // actualPeriod = i+1 (difference of periods (in years) from 0 (initialDate) to the actual one)
-            // The ith element of the zeroCoupon forward rate is the forward rate from i to i+1 and is set in the
-            // ith zeroCoupon object of the zeroCouponVector. IT can be access by getFoward(int i)
-            this->zeroCouponVector[i].setForward(this->zeroCouponVector[i-1].getTime(),
-                    this->zeroCouponVector[i-1].getInterestRate(), this->numOfPeriodsPerYear, i+1);
-
-            // Build the curve
-            time.push_back(this->zeroCouponVector[i].getTime());
-            zeroCouponRate.push_back(this->zeroCouponVector[i].getInterestRate());  // _zeroCouponInterestRate
-        }
+        this->computeForward(i);
+
+        // Build the curve
+        this->pillarTimes.push_back(this->zeroCouponVector[i].getTime());
+        this->pillarRates.push_back(this->zeroCouponVector[i].getInterestRate());  // _zeroCouponInterestRate
+    }
+    this->spline.set_points(this->pillarTimes, this->pillarRates);  // Prints the interest rates for diff periods
+    this->version = nextCurveVersion();
+}
+
+template <class T, class C>
+void ZeroCouponYieldCurve<T, C>::computeForward(int i)
+{
+    if(i == 0)
+    {
+        // First element of the rate vector (Forward rate from start period (i=0) to following one (i+1))
+        // zeroCouponVector[i].getTime(): diff in years from initial_period to _date[i]
+        this->zeroCouponVector[i].setForward( 0, 0, this->numOfPeriodsPerYear, i+1);
+    }
+    else
+    {
+        // Elements of forward rate vector but 1st one (forward rate between two consecutive dates)
+        // zeroCouponVector[i-1].getTime(): diff in years from initial_period to _date[i-1] (_date[i-1] end of the (i-1) period and start of the following one (i))
+        // zeroCouponVector[i-1].getInterestRate(): interest rate from the previous period (period from i-1 to i)
+        // actualPeriod = i+1 (difference of periods (in years) from 0 (initialDate) to the actual one)
+        // The ith element of the zeroCoupon forward rate is the forward rate from i to i+1 and is set in the
+        // ith zeroCoupon object of the zeroCouponVector. IT can be access by getFoward(int i)
+        this->zeroCouponVector[i].setForward(this->zeroCouponVector[i-1].getTime(),
+                this->zeroCouponVector[i-1].getInterestRate(), this->numOfPeriodsPerYear, i+1);
+    }
+}
+
+template <class T, class C>
+bool ZeroCouponYieldCurve<T, C>::updateRate(int i, double newRate)
+{
+    if (i < 0 || i >= this->getNumberOfRates() || this->pillarRates.size() != this->getNumberOfRates())
+    {
+        return false;
+    }
+
+    // Only the ith rate moved (computeZeroCurve must have been called before):
+    // - The pillar dates do not change, so neither do the times nor numOfPeriodsPerYear
+    // - Only the forwards that depend on the ith rate change: the one ending at i and the one starting at i
+    // - The spline is solved again on the stored knots, with no vector rebuilt
+    this->zeroCouponVector[i].setInterestRate(newRate);
+    this->pillarRates[i] = newRate;
+
+    this->computeForward(i);
+    if(i+1 < this->zeroCouponVector.size())
+    {
+        this->computeForward(i+1);
     }
-    this->spline.set_points(time,zeroCouponRate);  // Prints the interest rates for diff periods
+
+    this->spline.set_points(this->pillarTimes, this->pillarRates);
+    this->version = nextCurveVersion();
+    return true;
 }
 
-template <class T>
-double ZeroCouponYieldCurve<T>::getForward(int i)
+template <class T, class C>
+double ZeroCouponYieldCurve<T, C>::getForward(int i) const
 {
     // Forward rate of the zeroCoupon[i] object from period i to period i+1
     return this->zeroCouponVector[i].getForward();
 }
 
-template <class T>
-double ZeroCouponYieldCurve<T>::getInterpolatedZCRate(double years)
+template <class T, class C>
+double ZeroCouponYieldCurve<T, C>::getInterpolatedZCRate(double years) const
 {
     // Returns the interpolation: forward rate for the period of length years (date: initial_date + years)
     return this->spline(years);
 }
 
-template <class T>
-double ZeroCouponYieldCurve<T>::getForward(std::tm _firstPeriodDate, std::tm _lastPeriodDate)
+template <class T, class C>
+double ZeroCouponYieldCurve<T, C>::getForward(std::tm _firstPeriodDate, std::tm _lastPeriodDate) const
 {
     // Forward rate between _firstPeriodDate and _lastPeriodDate
     double _firstDate = this->dayCountConvention.compute_daycount(this->initialDate, _firstPeriodDate) / 360; // In years
     double _lastDate = this->dayCountConvention.compute_daycount(this->initialDate, _lastPeriodDate) / 360;   // In years
+    return this->getForward(_firstDate, _lastDate);
+}
+
+template <class T, class C>
+double ZeroCouponYieldCurve<T, C>::getForward(double _firstDate, double _lastDate) const
+{
     double _numOfPeriodsPerYear = (double)round(1/(_lastDate - _firstDate));
 
-    // Forward rate from _firstDate to _lastDate. Here fractional periods are consider since
-    // multiplying (ZC_last*_lastDate-ZC_first*_firstDate) by _numOfPeriodsPerYear is the same as computing
-    // (ZC_last*_lastDate-ZC_first*_firstDate)/(_lastDate-_firstDate), so diff in dates is considered (as an approx)
-    double RF = (this->getInterpolatedZCRate(_lastDate)*(_lastDate * _numOfPeriodsPerYear) -
-                this->getInterpolatedZCRate(_firstDate)*(_firstDate * _numOfPeriodsPerYear));
-    // Switching from continuously compounded to annually compounded
-    // Divided by _numOfPeriodsPerYear cause it cancels with this factor in RF,
-    // so it is the forward interest in the units of _numOfPeriodsPerYear (years)
-    return _numOfPeriodsPerYear * (exp(RF/_numOfPeriodsPerYear) - 1);
+    // Growth factor from _firstDate to _lastDate. The period is approximated by 1/_numOfPeriodsPerYear instead of
+    // (_lastDate-_firstDate), so the forward is expressed in the units of _numOfPeriodsPerYear (years)
+    double growth = C::forwardGrowthFactor(this->getInterpolatedZCRate(_firstDate), _firstDate,
+                                           this->getInterpolatedZCRate(_lastDate), _lastDate);
+    // Switching from the curve compounding to compounded once per period of length 1/_numOfPeriodsPerYear
+    // (which is the simple rate over that period)
+    return SimpleCompounding::rateFromGrowthFactor(growth, 1 / _numOfPeriodsPerYear);
 }
 
-template <class T>
-void ZeroCouponYieldCurve<T>::setNumOfPeriodsPerYear(double i)
+template <class T, class C>
+void ZeroCouponYieldCurve<T, C>::setNumOfPeriodsPerYear(double i)
 {
     this->numOfPeriodsPerYear = i;
 }
 
-template <class T>
-double ZeroCouponYieldCurve<T>::getDiscountFactor(int i)
+template <class T, class C>
+double ZeroCouponYieldCurve<T, C>::getDiscountFactor(int i) const
 {
-    return exp(- this->zeroCouponVector[i].getInterestRate()* this->zeroCouponVector[i].getTime());
+    return C::discountFactor(this->zeroCouponVector[i].getInterestRate(), this->zeroCouponVector[i].getTime());
 }
 
-template <class T>
-std::tm ZeroCouponYieldCurve<T>::getPresentValue()
+template <class T, class C>
+std::tm ZeroCouponYieldCurve<T, C>::getPresentValue() const
 {
     return this->initialDate;
 }
 
-template <class T>
-T ZeroCouponYieldCurve<T>::getDayCountConvention()
+template <class T, class C>
+T ZeroCouponYieldCurve<T, C>::getDayCountConvention() const
 {
     return this->dayCountConvention;
 }
 
-template <class T>
-double ZeroCouponYieldCurve<T>::getNumOfPeriodsPerYear()
+template <class T, class C>
+double ZeroCouponYieldCurve<T, C>::getNumOfPeriodsPerYear() const
 {
     return this->numOfPeriodsPerYear;
 }
 
-template <class T>
-double ZeroCouponYieldCurve<T>::getTimeInYearsFromPresentDate(std::tm _time)
+template <class T, class C>
+double ZeroCouponYieldCurve<T, C>::getTimeInYearsFromPresentDate(std::tm _time) const
 {
     return this->dayCountConvention.compute_daycount(this->initialDate, _time) / 360;  // In year units (days/360)
 }
 
+// Compounding of the rates of a curve type, so the instruments can discount with the convention of their curve
+// (continuous for the types that are not zero coupon curves, such as the day count conventions)
+template <class CURVE>
+struct CurveCompounding
+{
+    typedef ContinuousCompounding type;
+};
+
+template <class T, class C>
+struct CurveCompounding<ZeroCouponYieldCurve<T, C>>
+{
+    typedef C type;
+};
+
 #endif //SQF_ZEROCOUPONYIELDCURVE_H